@@ -0,0 +1,126 @@
+/***********************************************
+ * Project: RaspberryConway
+ * File: bitboard.cpp
+ * By: ProgrammingIncluded
+ * Website: ProgrammingIncluded.github.io
+ * License: GNU GPLv3 (see LICENSE file)
+***********************************************/
+
+#include "bitboard.hpp"
+#include "kernel.hpp"
+
+#include <cstring>
+
+BitBoard::BitBoard(uint width, uint height, uint planes) {
+    this->width = width;
+    this->height = height;
+    this->stride = (width + 63) / 64;
+    this->pitch = this->stride + 2;
+    this->lastMask = (width % 64 == 0) ? ~(uint64_t) 0 : ((uint64_t) 1 << (width % 64)) - 1;
+    this->planes = planes;
+    this->planeWords = (long) this->pitch * (height + 2);
+    this->memory = new uint64_t[this->planeWords * planes]();
+    // Skip the ghost row and the ghost word of row 0
+    this->cells = this->memory + this->pitch + 1;
+}
+
+BitBoard::~BitBoard() {
+    delete[] this->memory;
+}
+
+void BitBoard::clear() {
+    memset(this->memory, 0, sizeof(uint64_t) * this->planeWords * this->planes);
+}
+
+void BitBoard::fillHalo(Boundary boundary) {
+    this->fillHalo(boundary, 0, this->stride, 0, this->height);
+}
+
+void BitBoard::fillHalo(Boundary boundary, uint startWord, uint endWord, uint startY, uint endY) {
+    // Dead ghosts are never written so there is nothing to do
+    if (boundary == DEAD_EDGES) {
+        return;
+    }
+
+    // The east ghost cell sits right after the last cell, which is either
+    // in the padding bits of the last word or bit 0 of the ghost word
+    uint eastWord = this->width >> 6;
+    uint64_t eastBit = (uint64_t) 1 << (this->width & 63);
+    uint lastX = this->width - 1;
+    bool west = (startWord == 0);
+    bool east = (endWord == this->stride);
+
+    for (uint p = 0; p < this->planes; ++p) {
+        for (uint y = startY; y < endY; ++y) {
+            uint64_t *cur = this->row(y, p);
+            // The last cell wraps to the west ghost of the row and the
+            // first cell to the east ghost
+            if (east) {
+                cur[-1] = (uint64_t) this->get(lastX, y, p) << 63;
+            }
+            if (west) {
+                cur[eastWord] = (cur[eastWord] & ~eastBit) | (this->get(0, y, p) ? eastBit : 0);
+            }
+        }
+
+        // Ghost rows wrap, along with the ghost words written above so
+        // the corners are set too
+        if (endY == this->height) {
+            this->copyRow(this->height - 1, -1, p, startWord, endWord);
+        }
+        if (startY == 0) {
+            this->copyRow(0, this->height, p, startWord, endWord);
+        }
+    }
+}
+
+void BitBoard::copyRow(int from, int to, uint plane, uint startWord, uint endWord) {
+    const uint64_t *source = this->row(from, plane);
+    uint64_t *ghost = this->row(to, plane);
+
+    memcpy(ghost + startWord, source + startWord, sizeof(uint64_t) * (endWord - startWord));
+    // Ghost words go with the cells they were copied from
+    if (endWord == this->stride) {
+        ghost[-1] = source[-1];
+    }
+    if (startWord == 0 && this->width % 64 == 0) {
+        ghost[this->stride] = source[this->stride];
+    }
+}
+
+bool stepTile(
+    const BitBoard &src, BitBoard &dst,
+    uint startWord, uint endWord, uint startY, uint endY
+) {
+    uint words = endWord - startWord;
+    bool lastWord = (endWord == src.stride);
+    const LifeKernel &kernel = lifeKernel();
+    uint64_t diff = 0;
+
+    for (uint y = startY; y < endY; ++y) {
+        kernel.step(
+            src.row(y - 1) + startWord, src.row(y) + startWord, src.row(y + 1) + startWord,
+            dst.row(y) + startWord, words, src.planeWords
+        );
+
+        for (uint p = 0; p < src.planes; ++p) {
+            const uint64_t *mid = src.row(y, p) + startWord;
+            uint64_t *out = dst.row(y, p) + startWord;
+
+            // Keep cells past the board edge dead
+            uint full = words;
+            if (lastWord) {
+                out[words - 1] &= src.lastMask;
+                // Torus ghost cells may sit in the padding bits of src
+                diff |= (out[words - 1] ^ mid[words - 1]) & src.lastMask;
+                full -= 1;
+            }
+
+            for (uint i = 0; i < full; ++i) {
+                diff |= out[i] ^ mid[i];
+            }
+        }
+    }
+
+    return diff != 0;
+}
@@ -0,0 +1,120 @@
+/***********************************************
+ * Project: RaspberryConway
+ * File: bitboard.hpp
+ * By: ProgrammingIncluded
+ * Website: ProgrammingIncluded.github.io
+ * License: GNU GPLv3 (see LICENSE file)
+***********************************************/
+#ifndef BITBOARD_HPP
+#define BITBOARD_HPP
+
+#include <cstdint>
+
+typedef unsigned int uint;
+
+// What lies past the edges of the board
+enum Boundary {
+    // Everything outside is dead
+    DEAD_EDGES,
+    // Opposite edges are joined
+    TORUS
+};
+
+// Board with one bit per cell, 64 cells packed into each word.
+// Cell x of a row lives in bit (x % 64) of word (x / 64).
+//
+// Every row has a ghost word before and after it and there is a ghost row
+// above and below the board, so row(-1) through row(height) are valid and
+// row(y)[-1] through row(y)[stride] are valid. Kernels read neighbours from
+// the ghosts instead of checking edges. fillHalo sets them for a boundary.
+//
+// Rules with more than two states keep one bit of the state per plane,
+// each plane laid out as above and planeWords after the one before.
+// get and set work on plane 0, so alive is state 1.
+class BitBoard {
+    public:
+        uint width;
+        uint height;
+        // Words per row, not counting ghost words
+        uint stride;
+        // Words between the start of two rows
+        uint pitch;
+        // Mask of valid bits for the last word of each row
+        uint64_t lastMask;
+        uint planes;
+        // Words between the same row of two planes
+        long planeWords;
+        // Word 0 of row 0
+        uint64_t *cells;
+
+        BitBoard(uint width, uint height, uint planes = 1);
+        ~BitBoard();
+
+        inline uint64_t *row(int y, uint plane = 0) const {
+            return this->cells + plane * this->planeWords + ((long) y * this->pitch);
+        }
+
+        inline bool get(uint x, uint y, uint plane = 0) const {
+            return (this->row(y, plane)[x >> 6] >> (x & 63)) & 1;
+        }
+
+        inline uint state(uint x, uint y) const {
+            uint state = 0;
+            for (uint p = 0; p < this->planes; ++p) {
+                state |= this->get(x, y, p) << p;
+            }
+            return state;
+        }
+
+        inline void set(uint x, uint y, bool alive = true) {
+            uint64_t bit = (uint64_t) 1 << (x & 63);
+            uint64_t *word = this->row(y) + (x >> 6);
+            *word = alive ? (*word | bit) : (*word & ~bit);
+        }
+
+        inline void setState(uint x, uint y, uint state) {
+            for (uint p = 0; p < this->planes; ++p) {
+                uint64_t bit = (uint64_t) 1 << (x & 63);
+                uint64_t *word = this->row(y, p) + (x >> 6);
+                *word = ((state >> p) & 1) ? (*word | bit) : (*word & ~bit);
+            }
+        }
+
+        void clear();
+
+        // Copy the cells around the board into the ghost cells for the
+        // given boundary. Needs to run on the source board before a step.
+        void fillHalo(Boundary boundary);
+
+        // Only the ghost cells copied from words [startWord, endWord) of
+        // rows [startY, endY). Disjoint areas write disjoint ghosts as
+        // long as width is a multiple of 64, otherwise the east ghost cell
+        // shares the last word of the row with the board.
+        void fillHalo(Boundary boundary, uint startWord, uint endWord, uint startY, uint endY);
+
+    private:
+        // Whole allocation including ghosts
+        uint64_t *memory;
+
+        // Copy words of a row into a ghost row for fillHalo
+        void copyRow(int from, int to, uint plane, uint startWord, uint endWord);
+
+        // Disallow copy constructor
+        BitBoard(const BitBoard&) = delete;
+};
+
+// Compute next generation of rows [startY, endY) and words
+// [startWord, endWord) of each row from src into dst. Neighbouring words
+// and rows are read in place, past the board they are the ghost cells.
+// Returns true if any cell of the tile changed, in any plane.
+bool stepTile(
+    const BitBoard &src, BitBoard &dst,
+    uint startWord, uint endWord, uint startY, uint endY
+);
+
+// Whole rows [startY, endY)
+inline void stepRows(const BitBoard &src, BitBoard &dst, uint startY, uint endY) {
+    stepTile(src, dst, 0, src.stride, startY, endY);
+}
+
+#endif /* BITBOARD_HPP */
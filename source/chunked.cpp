@@ -0,0 +1,219 @@
+/***********************************************
+ * Project: RaspberryConway
+ * File: chunked.cpp
+ * By: ProgrammingIncluded
+ * Website: ProgrammingIncluded.github.io
+ * License: GNU GPLv3 (see LICENSE file)
+***********************************************/
+
+#include "chunked.hpp"
+#include "kernel.hpp"
+
+// Rows of a chunk that is not allocated
+static const uint64_t EMPTY_ROWS[CHUNK_SIZE] = {};
+
+// Cells of rows on the side facing the neighbour dx, dy away
+static uint64_t edge(const uint64_t *rows, int dx, int dy) {
+    uint64_t cells = 0;
+    if (dy < 0) {
+        cells = rows[0];
+    } else if (dy > 0) {
+        cells = rows[CHUNK_SIZE - 1];
+    } else {
+        for (uint r = 0; r < CHUNK_SIZE; ++r) {
+            cells |= rows[r];
+        }
+    }
+
+    if (dx < 0) {
+        return cells & 1;
+    }
+    if (dx > 0) {
+        return cells >> 63;
+    }
+    return cells;
+}
+
+ChunkedBoard::ChunkedBoard() {
+    this->current = 0;
+}
+
+ChunkedBoard::~ChunkedBoard() {
+    for (Chunk *chunk : this->list) {
+        delete chunk;
+    }
+}
+
+Chunk *ChunkedBoard::find(lint x, lint y) const {
+    std::unordered_map<uint64_t, Chunk*>::const_iterator found = this->map.find(key(x, y));
+    return (found == this->map.end()) ? nullptr : found->second;
+}
+
+Chunk *ChunkedBoard::allocate(lint x, lint y) {
+    Chunk *&chunk = this->map[key(x, y)];
+    if (chunk == nullptr) {
+        chunk = new Chunk();
+        chunk->x = x;
+        chunk->y = y;
+        this->list.push_back(chunk);
+    }
+    return chunk;
+}
+
+bool ChunkedBoard::get(lint x, lint y) const {
+    const Chunk *chunk = this->find(x >> CHUNK_SHIFT, y >> CHUNK_SHIFT);
+    if (chunk == nullptr) {
+        return false;
+    }
+    return (chunk->rows[this->current][y & (CHUNK_SIZE - 1)] >> (x & (CHUNK_SIZE - 1))) & 1;
+}
+
+void ChunkedBoard::set(lint x, lint y, bool alive) {
+    Chunk *chunk = alive ? this->allocate(x >> CHUNK_SHIFT, y >> CHUNK_SHIFT)
+                         : this->find(x >> CHUNK_SHIFT, y >> CHUNK_SHIFT);
+    if (chunk == nullptr) {
+        return;
+    }
+
+    uint64_t &row = chunk->rows[this->current][y & (CHUNK_SIZE - 1)];
+    uint64_t bit = (uint64_t) 1 << (x & (CHUNK_SIZE - 1));
+    row = alive ? (row | bit) : (row & ~bit);
+}
+
+ulint ChunkedBoard::population() const {
+    ulint count = 0;
+    for (const Chunk *chunk : this->list) {
+        for (uint r = 0; r < CHUNK_SIZE; ++r) {
+            count += __builtin_popcountll(chunk->rows[this->current][r]);
+        }
+    }
+    return count;
+}
+
+void ChunkedBoard::grow(const Chunk &chunk) {
+    const uint64_t *rows = chunk.rows[this->current];
+    for (int dy = -1; dy <= 1; ++dy) {
+        for (int dx = -1; dx <= 1; ++dx) {
+            if ((dx != 0 || dy != 0) && edge(rows, dx, dy) != 0) {
+                this->allocate(chunk.x + dx, chunk.y + dy);
+            }
+        }
+    }
+}
+
+bool ChunkedBoard::reached(const Chunk &chunk) const {
+    for (int dy = -1; dy <= 1; ++dy) {
+        for (int dx = -1; dx <= 1; ++dx) {
+            if (dx == 0 && dy == 0) {
+                continue;
+            }
+
+            const Chunk *next = this->find(chunk.x + dx, chunk.y + dy);
+            if (next != nullptr && edge(next->rows[this->current], -dx, -dy) != 0) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+void ChunkedBoard::stepChunk(Chunk &chunk) const {
+    const uint64_t *around[3][3];
+    for (int dy = -1; dy <= 1; ++dy) {
+        for (int dx = -1; dx <= 1; ++dx) {
+            const Chunk *next = this->find(chunk.x + dx, chunk.y + dy);
+            around[dy + 1][dx + 1] = (next == nullptr) ? EMPTY_ROWS : next->rows[this->current];
+        }
+    }
+
+    // Rows of the chunk and one either side, each with the cells west and
+    // east of it in ghost words as the kernels expect
+    uint64_t rows[CHUNK_SIZE + 2][3];
+    for (uint c = 0; c < 3; ++c) {
+        rows[0][c] = around[0][c][CHUNK_SIZE - 1];
+        rows[CHUNK_SIZE + 1][c] = around[2][c][0];
+        for (uint r = 0; r < CHUNK_SIZE; ++r) {
+            rows[r + 1][c] = around[1][c][r];
+        }
+    }
+
+    const LifeKernel &kernel = lifeKernel();
+    uint64_t *out = chunk.rows[this->current ^ 1];
+    for (uint r = 0; r < CHUNK_SIZE; ++r) {
+        kernel.step(rows[r] + 1, rows[r + 1] + 1, rows[r + 2] + 1, out + r, 1);
+    }
+}
+
+void ChunkedBoard::step(ThreadPool &pool) {
+    // New chunks are empty and added to the end, so they need no growing
+    size_t count = this->list.size();
+    for (size_t i = 0; i < count; ++i) {
+        this->grow(*this->list[i]);
+    }
+
+    // Chunks only write their own next rows, the map is not changed
+    pool.run(this->list.size(), [this](uint i) {
+        this->stepChunk(*this->list[i]);
+    });
+    this->current ^= 1;
+
+    // Free empty chunks no cells are about to reach. Freed chunks are
+    // empty, so dropping them early does not change what reached sees.
+    size_t kept = 0;
+    for (size_t i = 0; i < this->list.size(); ++i) {
+        Chunk *chunk = this->list[i];
+        if (edge(chunk->rows[this->current], 0, 0) == 0 && !this->reached(*chunk)) {
+            this->map.erase(key(chunk->x, chunk->y));
+            delete chunk;
+        } else {
+            this->list[kept++] = chunk;
+        }
+    }
+    this->list.resize(kept);
+}
+
+void ChunkedBoard::render(BitBoard &view, lint x, lint y) const {
+    view.clear();
+
+    lint firstX = x >> CHUNK_SHIFT;
+    lint lastX = (x + view.width - 1) >> CHUNK_SHIFT;
+    lint firstY = y >> CHUNK_SHIFT;
+    lint lastY = (y + view.height - 1) >> CHUNK_SHIFT;
+
+    for (lint cy = firstY; cy <= lastY; ++cy) {
+        for (lint cx = firstX; cx <= lastX; ++cx) {
+            const Chunk *chunk = this->find(cx, cy);
+            if (chunk == nullptr) {
+                continue;
+            }
+
+            // Where the chunk starts in the view, may be left of or above it
+            lint left = cx * CHUNK_SIZE - x;
+            lint top = cy * CHUNK_SIZE - y;
+            uint shift = left & 63;
+            lint word = left >> 6;
+
+            for (uint r = 0; r < CHUNK_SIZE; ++r) {
+                lint vy = top + r;
+                uint64_t cells = chunk->rows[this->current][r];
+                if (vy < 0 || vy >= view.height || cells == 0) {
+                    continue;
+                }
+
+                // Cells straddle two words of the view unless aligned
+                uint64_t *out = view.row(vy);
+                if (word >= 0) {
+                    out[word] |= cells << shift;
+                }
+                if (shift != 0 && word + 1 < view.stride) {
+                    out[word + 1] |= cells >> (64 - shift);
+                }
+            }
+        }
+    }
+
+    // Keep padding bits past the view clear
+    for (uint vy = 0; vy < view.height; ++vy) {
+        view.row(vy)[view.stride - 1] &= view.lastMask;
+    }
+}
@@ -0,0 +1,83 @@
+/***********************************************
+ * Project: RaspberryConway
+ * File: chunked.hpp
+ * By: ProgrammingIncluded
+ * Website: ProgrammingIncluded.github.io
+ * License: GNU GPLv3 (see LICENSE file)
+***********************************************/
+#ifndef CHUNKED_HPP
+#define CHUNKED_HPP
+
+#include "bitboard.hpp"
+#include "threadpool.hpp"
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+typedef long long int lint;
+
+// Chunks are CHUNK_SIZE cells square, one word per row
+const uint CHUNK_SHIFT = 6;
+const uint CHUNK_SIZE = 1 << CHUNK_SHIFT;
+
+// Square of the plane with cell x of a row in bit x of its word
+struct Chunk {
+    // Position in chunks, the first cell is at (x * CHUNK_SIZE, y * CHUNK_SIZE)
+    lint x;
+    lint y;
+    // This generation and the next, swapped every step
+    uint64_t rows[2][CHUNK_SIZE];
+};
+
+// Unbounded plane kept as a hash map of bit packed chunks. A chunk is
+// allocated once cells reach its edge from a neighbour and freed once it
+// and the edges facing it are empty, so memory follows the active area
+// and patterns can grow forever. Uses the kernel of lifeKernel(), two
+// state B/S rules only. Coordinates fit in 32 bits of chunks.
+class ChunkedBoard {
+    public:
+        ChunkedBoard();
+        ~ChunkedBoard();
+
+        bool get(lint x, lint y) const;
+        void set(lint x, lint y, bool alive = true);
+
+        inline size_t chunks() const {
+            return this->list.size();
+        }
+
+        ulint population() const;
+
+        // Step every chunk once, chunks are handed out to the pool
+        void step(ThreadPool &pool);
+
+        // Draw the cells from (x, y) to (x + view.width, y + view.height)
+        // into view, anything else in view is cleared
+        void render(BitBoard &view, lint x, lint y) const;
+
+    private:
+        std::unordered_map<uint64_t, Chunk*> map;
+        // Same chunks as map, so they can be handed out by index
+        std::vector<Chunk*> list;
+        // Which rows of each chunk hold this generation
+        uint current;
+
+        static inline uint64_t key(lint x, lint y) {
+            return ((uint64_t) (uint32_t) y << 32) | (uint32_t) x;
+        }
+
+        Chunk *find(lint x, lint y) const;
+        Chunk *allocate(lint x, lint y);
+
+        // Allocate the neighbours that cells on the edges of chunk reach
+        void grow(const Chunk &chunk);
+        // True if any neighbour has cells on the edge facing chunk
+        bool reached(const Chunk &chunk) const;
+        void stepChunk(Chunk &chunk) const;
+
+        // Disallow copy constructor
+        ChunkedBoard(const ChunkedBoard&) = delete;
+};
+
+#endif /* CHUNKED_HPP */
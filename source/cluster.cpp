@@ -0,0 +1,367 @@
+/***********************************************
+ * Project: RaspberryConway
+ * File: cluster.cpp
+ * By: ProgrammingIncluded
+ * Website: ProgrammingIncluded.github.io
+ * License: GNU GPLv3 (see LICENSE file)
+***********************************************/
+
+#include "cluster.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <chrono>
+#include <iostream>
+#include <thread>
+
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+// How long to keep trying to reach the next rank while it starts up
+static const uint CONNECT_TRIES = 200;
+static const uint CONNECT_WAIT_MS = 50;
+
+static const std::string UNIX_PREFIX = "unix:";
+
+// Socket address of a host:port or unix:<path> address
+struct Address {
+    sockaddr_storage storage;
+    socklen_t length;
+    bool local;
+};
+
+static bool resolve(const std::string &text, Address &address) {
+    memset(&address.storage, 0, sizeof(address.storage));
+
+    if (text.compare(0, UNIX_PREFIX.size(), UNIX_PREFIX) == 0) {
+        std::string path = text.substr(UNIX_PREFIX.size());
+        sockaddr_un *un = (sockaddr_un *) &address.storage;
+        if (path.size() >= sizeof(un->sun_path)) {
+            return false;
+        }
+        un->sun_family = AF_UNIX;
+        strcpy(un->sun_path, path.c_str());
+        address.length = sizeof(sockaddr_un);
+        address.local = true;
+        return true;
+    }
+
+    size_t colon = text.rfind(':');
+    if (colon == std::string::npos) {
+        return false;
+    }
+
+    addrinfo hints;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo *found = nullptr;
+    if (getaddrinfo(text.substr(0, colon).c_str(), text.substr(colon + 1).c_str(), &hints, &found) != 0) {
+        return false;
+    }
+
+    memcpy(&address.storage, found->ai_addr, found->ai_addrlen);
+    address.length = found->ai_addrlen;
+    address.local = false;
+    freeaddrinfo(found);
+    return true;
+}
+
+static int openSocket(const Address &address) {
+    int fd = socket(address.storage.ss_family, SOCK_STREAM, 0);
+    if (fd >= 0 && !address.local) {
+        // Halo rows are small and every generation waits on them
+        int on = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+    }
+    return fd;
+}
+
+static int listenOn(const Address &address) {
+    int fd = openSocket(address);
+    if (fd < 0) {
+        return -1;
+    }
+
+    int on = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+    if (address.local) {
+        unlink(((const sockaddr_un *) &address.storage)->sun_path);
+    }
+
+    if (bind(fd, (const sockaddr *) &address.storage, address.length) != 0 || listen(fd, 1) != 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static int connectTo(const Address &address) {
+    for (uint attempt = 0; attempt < CONNECT_TRIES; ++attempt) {
+        int fd = openSocket(address);
+        if (fd < 0) {
+            return -1;
+        }
+        if (connect(fd, (const sockaddr *) &address.storage, address.length) == 0) {
+            return fd;
+        }
+
+        close(fd);
+        std::this_thread::sleep_for(std::chrono::milliseconds(CONNECT_WAIT_MS));
+    }
+    return -1;
+}
+
+// Blocking send or receive of a whole buffer, used before the links are
+// made non blocking
+static bool sendAll(int fd, const void *data, size_t bytes) {
+    const char *at = (const char *) data;
+    while (bytes > 0) {
+        ssize_t done = send(fd, at, bytes, MSG_NOSIGNAL);
+        if (done <= 0) {
+            return false;
+        }
+        at += done;
+        bytes -= done;
+    }
+    return true;
+}
+
+static bool receiveAll(int fd, void *data, size_t bytes) {
+    char *at = (char *) data;
+    while (bytes > 0) {
+        ssize_t done = recv(fd, at, bytes, 0);
+        if (done <= 0) {
+            return false;
+        }
+        at += done;
+        bytes -= done;
+    }
+    return true;
+}
+
+Cluster::Cluster(uint rank, const std::vector<std::string> &addresses, Boundary boundary) {
+    this->rank = rank;
+    this->ranks = addresses.size();
+    this->up = -1;
+    this->down = -1;
+    this->connected = false;
+
+    if (rank >= this->ranks) {
+        std::cout << "Rank " << rank << " has no address, " << this->ranks << " given" << std::endl;
+        return;
+    }
+
+    bool hasUp = (boundary == TORUS || rank > 0);
+    bool hasDown = (boundary == TORUS || rank + 1 < this->ranks);
+    uint downRank = (rank + 1) % this->ranks;
+    uint upRank = (rank + this->ranks - 1) % this->ranks;
+
+    Address self, next;
+    if (!resolve(addresses[rank], self) || !resolve(addresses[downRank], next)) {
+        std::cout << "Unable to resolve cluster addresses" << std::endl;
+        return;
+    }
+
+    // Listen before connecting, so a ring of ranks never waits on itself
+    int listener = -1;
+    if (hasUp) {
+        listener = listenOn(self);
+        if (listener < 0) {
+            std::cout << "Unable to listen on: " << addresses[rank] << std::endl;
+            return;
+        }
+    }
+
+    if (hasDown) {
+        this->down = connectTo(next);
+        uint32_t id = rank;
+        if (this->down < 0 || !sendAll(this->down, &id, sizeof(id))) {
+            std::cout << "Unable to connect to rank " << downRank << " at: " << addresses[downRank] << std::endl;
+            if (listener >= 0) {
+                close(listener);
+            }
+            return;
+        }
+    }
+
+    if (hasUp) {
+        this->up = accept(listener, nullptr, nullptr);
+        close(listener);
+
+        uint32_t id = 0;
+        if (this->up < 0 || !receiveAll(this->up, &id, sizeof(id)) || id != upRank) {
+            std::cout << "Expected rank " << upRank << " to connect, got " << id << std::endl;
+            return;
+        }
+    }
+
+    // Exchanges poll both links at once
+    if (this->up >= 0) {
+        fcntl(this->up, F_SETFL, fcntl(this->up, F_GETFL) | O_NONBLOCK);
+    }
+    if (this->down >= 0) {
+        fcntl(this->down, F_SETFL, fcntl(this->down, F_GETFL) | O_NONBLOCK);
+    }
+    this->connected = true;
+}
+
+Cluster::~Cluster() {
+    if (this->up >= 0) {
+        close(this->up);
+    }
+    if (this->down >= 0) {
+        close(this->down);
+    }
+}
+
+bool Cluster::exchange(
+    const void *sendUp, void *receiveUp,
+    const void *sendDown, void *receiveDown, size_t bytes
+) {
+    // Bytes left each way on each link
+    struct Transfer {
+        int fd;
+        char *data;
+        size_t left;
+        bool outgoing;
+    };
+
+    Transfer transfers[] = {
+        {this->up, (char *) sendUp, bytes, true},
+        {this->up, (char *) receiveUp, bytes, false},
+        {this->down, (char *) sendDown, bytes, true},
+        {this->down, (char *) receiveDown, bytes, false},
+    };
+
+    for (;;) {
+        pollfd polls[2];
+        Transfer *waiting[4];
+        uint count = 0;
+        uint pending = 0;
+
+        for (int fd : {this->up, this->down}) {
+            if (fd < 0) {
+                continue;
+            }
+            polls[count] = {fd, 0, 0};
+            for (Transfer &transfer : transfers) {
+                if (transfer.fd == fd && transfer.left > 0) {
+                    polls[count].events |= transfer.outgoing ? POLLOUT : POLLIN;
+                    waiting[pending++] = &transfer;
+                }
+            }
+            ++count;
+        }
+
+        if (pending == 0) {
+            return true;
+        }
+        if (poll(polls, count, -1) < 0 && errno != EINTR) {
+            std::cout << "Unable to poll the links to the neighbouring ranks: " << strerror(errno) << std::endl;
+            return false;
+        }
+
+        for (uint i = 0; i < pending; ++i) {
+            Transfer &transfer = *waiting[i];
+            if (transfer.left == 0) {
+                continue;
+            }
+
+            ssize_t done = transfer.outgoing
+                ? send(transfer.fd, transfer.data, transfer.left, MSG_NOSIGNAL)
+                : recv(transfer.fd, transfer.data, transfer.left, 0);
+
+            if (done > 0) {
+                transfer.data += done;
+                transfer.left -= done;
+            } else if (done == 0 || (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)) {
+                // The other rank is gone, its rows will never come
+                std::cout << "Lost link to a neighbouring rank" << std::endl;
+                int lost = transfer.fd;
+                close(lost);
+                this->up = (this->up == lost) ? -1 : this->up;
+                this->down = (this->down == lost) ? -1 : this->down;
+                this->connected = false;
+                return false;
+            }
+        }
+    }
+}
+
+bool stepStrip(
+    Cluster &cluster, BitBoard &board, BitBoard &next, uint range, Boundary boundary,
+    ThreadPool &pool, const std::function<void(const Tile &tile)> &step, double &waited
+) {
+    // First and last rows of the strip
+    uint top = range;
+    uint bottom = board.height - range;
+    // Rows more than range from either halo
+    uint innerStart = std::min(2 * range, bottom);
+    uint innerEnd = std::max(bottom - range, innerStart);
+
+    board.fillHalo(boundary);
+
+    // Twice as many stepping tasks as threads, so the thread doing the
+    // exchange does not hold the others up. On one thread nothing can
+    // overlap the exchange, so it goes after the stepping.
+    uint tasks = 2 * pool.size();
+    uint exchangeTask = (pool.size() == 1) ? tasks : 0;
+    std::atomic<uint> stepping(tasks);
+    std::chrono::steady_clock::time_point stepped, exchanged;
+    bool linked = true;
+
+    pool.run(tasks + 1, [&](uint t) {
+        if (t == exchangeTask) {
+            // range rows of a plane follow on in memory, ghost words and all
+            size_t bytes = sizeof(uint64_t) * board.pitch * range;
+            for (uint p = 0; p < board.planes && linked; ++p) {
+                linked = cluster.exchange(
+                    board.row(top, p) - 1, board.row(0, p) - 1,
+                    board.row(bottom - range, p) - 1, board.row(bottom, p) - 1, bytes
+                );
+            }
+            exchanged = std::chrono::steady_clock::now();
+            return;
+        }
+
+        uint i = (t < exchangeTask) ? t : t - 1;
+        uint startY = innerStart + (ulint) (innerEnd - innerStart) * i / tasks;
+        uint endY = innerStart + (ulint) (innerEnd - innerStart) * (i + 1) / tasks;
+        if (startY < endY) {
+            step({0, board.stride, startY, endY});
+        }
+        if (stepping.fetch_sub(1) == 1) {
+            stepped = std::chrono::steady_clock::now();
+        }
+    });
+
+    waited += std::max(0.0, std::chrono::duration<double, std::milli>(exchanged - stepped).count());
+    if (!linked) {
+        return false;
+    }
+
+    // The ghost words of the halo rows came from the old rows
+    board.fillHalo(boundary, 0, board.stride, 0, top);
+    board.fillHalo(boundary, 0, board.stride, bottom, bottom + range);
+
+    Tile edges[2] = {
+        {0, board.stride, top, innerStart},
+        {0, board.stride, innerEnd, bottom},
+    };
+    pool.run(2, [&edges, &step](uint i) {
+        if (edges[i].startY < edges[i].endY) {
+            step(edges[i]);
+        }
+    });
+    return true;
+}
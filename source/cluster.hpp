@@ -0,0 +1,73 @@
+/***********************************************
+ * Project: RaspberryConway
+ * File: cluster.hpp
+ * By: ProgrammingIncluded
+ * Website: ProgrammingIncluded.github.io
+ * License: GNU GPLv3 (see LICENSE file)
+***********************************************/
+#ifndef CLUSTER_HPP
+#define CLUSTER_HPP
+
+#include "bitboard.hpp"
+#include "threadpool.hpp"
+#include "tiling.hpp"
+
+#include <functional>
+#include <string>
+#include <vector>
+
+// Links between processes that share one board, each owning a strip of
+// rows. Every process (rank) listens on its own address and connects to
+// the rank below it, so each rank has a link up and a link down. On a
+// torus the last rank links back to the first, with dead edges the first
+// has no link up and the last no link down.
+//
+// Addresses are host:port for TCP or unix:<path> for a Unix socket, one
+// per rank in rank order, so several ranks can run on one machine.
+class Cluster {
+    public:
+        uint rank;
+        uint ranks;
+
+        // Blocks until both links are up, retrying for a while as the
+        // other ranks start
+        Cluster(uint rank, const std::vector<std::string> &addresses, Boundary boundary);
+        ~Cluster();
+
+        inline bool isConnected() const {
+            return this->connected;
+        }
+
+        // Send bytes to the ranks above and below and receive the same
+        // amount from each, all at once so neither side waits on the other.
+        // A missing link sends nothing and leaves its buffer untouched.
+        // Returns false if polling fails or a link is lost, the rows
+        // received are then not to be trusted.
+        bool exchange(
+            const void *sendUp, void *receiveUp,
+            const void *sendDown, void *receiveDown, size_t bytes
+        );
+
+    private:
+        // Sockets, -1 if there is no link
+        int up;
+        int down;
+        bool connected;
+
+        // Disallow copy constructor
+        Cluster(const Cluster&) = delete;
+};
+
+// Step this rank's strip one generation from board into next, which both
+// hold the strip with range rows of halo above and below it. One task of
+// the pool swaps the halo rows with the ranks above and below while the
+// others step the rows that do not need them, then the rows next to the
+// halo are stepped. step advances the rows of a tile of board into next.
+// Adds the time spent waiting on the exchange once the stepping was done
+// to waited. Returns false if a link failed.
+bool stepStrip(
+    Cluster &cluster, BitBoard &board, BitBoard &next, uint range, Boundary boundary,
+    ThreadPool &pool, const std::function<void(const Tile &tile)> &step, double &waited
+);
+
+#endif /* CLUSTER_HPP */
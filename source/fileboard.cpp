@@ -0,0 +1,266 @@
+/***********************************************
+ * Project: RaspberryConway
+ * File: fileboard.cpp
+ * By: ProgrammingIncluded
+ * Website: ProgrammingIncluded.github.io
+ * License: GNU GPLv3 (see LICENSE file)
+***********************************************/
+
+#include "fileboard.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <memory>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// pread and pwrite may move less than asked, keep going until done. On
+// an error whatever is left of a read is dead, and false is returned.
+static bool readFully(int fd, void *data, size_t bytes, off_t offset) {
+    char *at = (char *) data;
+    while (bytes > 0) {
+        ssize_t done = pread(fd, at, bytes, offset);
+        if (done <= 0) {
+            std::cout << "Board file read failed at: " << offset << std::endl;
+            memset(at, 0, bytes);
+            return false;
+        }
+        at += done;
+        bytes -= done;
+        offset += done;
+    }
+    return true;
+}
+
+static bool writeFully(int fd, const void *data, size_t bytes, off_t offset) {
+    const char *at = (const char *) data;
+    while (bytes > 0) {
+        ssize_t done = pwrite(fd, at, bytes, offset);
+        if (done <= 0) {
+            std::cout << "Board file write failed at: " << offset << std::endl;
+            return false;
+        }
+        at += done;
+        bytes -= done;
+        offset += done;
+    }
+    return true;
+}
+
+FileBoard::FileBoard(const std::string &path, uint width, uint height, uint planes) {
+    this->width = width;
+    this->height = height;
+    this->stride = (width + 63) / 64;
+    this->planes = planes;
+    this->rowBytes = sizeof(uint64_t) * this->stride * planes;
+    this->cached.resize(this->stride * planes);
+    this->cachedY = -1;
+    this->dirty = false;
+    this->failed = false;
+    this->resumed = false;
+
+    this->fd = open(path.c_str(), O_RDWR | O_CREAT, 0644);
+    if (this->fd < 0) {
+        std::cout << "Unable to open board file: " << path << std::endl;
+        return;
+    }
+
+    struct stat info;
+    off_t bytes = (off_t) this->rowBytes * height;
+    if (fstat(this->fd, &info) != 0) {
+        info.st_size = -1;
+    }
+
+    if (info.st_size == bytes && bytes != 0) {
+        this->resumed = true;
+    } else if (info.st_size == 0) {
+        // New file, sized up front. Unwritten parts read back as zeros.
+        if (ftruncate(this->fd, bytes) != 0) {
+            std::cout << "Unable to size board file: " << path << std::endl;
+            close(this->fd);
+            this->fd = -1;
+        }
+    } else {
+        std::cout << "Board file " << path << " is " << info.st_size << " bytes, a " << width << "x" << height
+                  << " board with " << planes << " planes is " << bytes << std::endl;
+        close(this->fd);
+        this->fd = -1;
+    }
+}
+
+FileBoard::~FileBoard() {
+    if (this->fd >= 0) {
+        this->flush();
+        close(this->fd);
+    }
+}
+
+void FileBoard::cacheRow(uint y) {
+    if (this->cachedY == (long) y) {
+        return;
+    }
+    this->flush();
+    this->failed |= !readFully(this->fd, this->cached.data(), this->rowBytes, (off_t) this->rowBytes * y);
+    this->cachedY = y;
+}
+
+void FileBoard::flush() {
+    if (this->dirty) {
+        this->failed |= !writeFully(this->fd, this->cached.data(), this->rowBytes, (off_t) this->rowBytes * this->cachedY);
+        this->dirty = false;
+    }
+    this->cachedY = -1;
+}
+
+bool FileBoard::get(uint x, uint y, uint plane) {
+    this->cacheRow(y);
+    return (this->cached[plane * this->stride + (x >> 6)] >> (x & 63)) & 1;
+}
+
+void FileBoard::set(uint x, uint y, bool alive) {
+    this->cacheRow(y);
+    uint64_t bit = (uint64_t) 1 << (x & 63);
+    uint64_t &word = this->cached[x >> 6];
+    word = alive ? (word | bit) : (word & ~bit);
+    this->dirty = true;
+}
+
+void FileBoard::readRows(BitBoard &window, long first, Boundary boundary) {
+    this->staging.resize(this->stride * this->planes * window.height);
+    memset(this->staging.data(), 0, sizeof(uint64_t) * this->staging.size());
+
+    // Rows that follow on in the file are read together
+    uint row = 0;
+    while (row < window.height) {
+        long y = first + row;
+        if (boundary == TORUS) {
+            y = ((y % (long) this->height) + this->height) % this->height;
+        } else if (y < 0 || y >= (long) this->height) {
+            ++row;
+            continue;
+        }
+
+        uint run = 1;
+        while (row + run < window.height && y + run < (long) this->height) {
+            ++run;
+        }
+
+        this->failed |= !readFully(
+            this->fd, this->staging.data() + (size_t) row * this->stride * this->planes,
+            this->rowBytes * run, (off_t) this->rowBytes * y
+        );
+        row += run;
+    }
+
+    const uint64_t *from = this->staging.data();
+    for (uint r = 0; r < window.height; ++r) {
+        for (uint p = 0; p < this->planes; ++p) {
+            memcpy(window.row(r, p), from, sizeof(uint64_t) * this->stride);
+            from += this->stride;
+        }
+    }
+}
+
+void FileBoard::writeRows(const BitBoard &window, uint from, uint y, uint count) {
+    this->staging.resize(this->stride * this->planes * count);
+
+    uint64_t *to = this->staging.data();
+    for (uint r = from; r < from + count; ++r) {
+        for (uint p = 0; p < this->planes; ++p) {
+            memcpy(to, window.row(r, p), sizeof(uint64_t) * this->stride);
+            to += this->stride;
+        }
+    }
+
+    this->failed |= !writeFully(this->fd, this->staging.data(), this->rowBytes * count, (off_t) this->rowBytes * y);
+}
+
+void FileBoard::render(BitBoard &view, uint x, uint y) {
+    this->flush();
+    view.clear();
+
+    uint shift = x & 63;
+    uint start = x >> 6;
+    std::vector<uint64_t> line(this->stride * this->planes);
+
+    for (uint vy = 0; vy < view.height && y + vy < this->height; ++vy) {
+        this->failed |= !readFully(this->fd, line.data(), this->rowBytes, (off_t) this->rowBytes * (y + vy));
+
+        for (uint p = 0; p < view.planes && p < this->planes; ++p) {
+            const uint64_t *cells = line.data() + p * this->stride;
+            uint64_t *out = view.row(vy, p);
+
+            // Every word of the view straddles two words of the row
+            for (uint i = 0; i < view.stride && start + i < this->stride; ++i) {
+                uint64_t word = cells[start + i] >> shift;
+                if (shift != 0 && start + i + 1 < this->stride) {
+                    word |= cells[start + i + 1] << (64 - shift);
+                }
+                out[i] = word;
+            }
+            out[view.stride - 1] &= view.lastMask;
+        }
+    }
+}
+
+bool stepFileBoard(FileBoard &src, FileBoard &dst, uint blockRows, Boundary boundary, ThreadPool &pool) {
+    src.flush();
+    dst.flush();
+
+    blockRows = std::max(1u, std::min(blockRows, src.height));
+    uint blocks = (src.height + blockRows - 1) / blockRows;
+    auto rowsOf = [&src, blockRows](uint block) {
+        return std::min(blockRows, src.height - block * blockRows);
+    };
+
+    // Two windows each way so one can be stepped while the other is on
+    // its way to or from the disk. Row 0 and the last row of a window are
+    // the halo rows around the block.
+    std::unique_ptr<BitBoard> in[2], out[2];
+    for (uint i = 0; i < 2; ++i) {
+        in[i].reset(new BitBoard(src.width, blockRows + 2, src.planes));
+        out[i].reset(new BitBoard(src.width, blockRows + 2, src.planes));
+    }
+
+    src.readRows(*in[0], -1, boundary);
+
+    for (uint k = 0; k < blocks && src.ok() && dst.ok(); ++k) {
+        BitBoard &window = *in[k % 2];
+        BitBoard &next = *out[k % 2];
+        uint rows = rowsOf(k);
+
+        // Only the ghost words matter, the ghost rows of the window are
+        // never read since its first and last rows are not stepped
+        window.fillHalo(boundary);
+
+        // Task 0 writes the last block and reads the next while the rest
+        // step this one. Twice as many stepping tasks as threads, so the
+        // thread doing the I/O does not hold the others up.
+        uint tasks = 2 * pool.size();
+        pool.run(tasks + 1, [&, k, rows, tasks](uint t) {
+            if (t == 0) {
+                if (k > 0) {
+                    dst.writeRows(*out[(k - 1) % 2], 1, (k - 1) * blockRows, rowsOf(k - 1));
+                }
+                if (k + 1 < blocks) {
+                    src.readRows(*in[(k + 1) % 2], (long) (k + 1) * blockRows - 1, boundary);
+                }
+                return;
+            }
+
+            uint startY = 1 + rows * (t - 1) / tasks;
+            uint endY = 1 + rows * t / tasks;
+            if (startY < endY) {
+                stepTile(window, next, 0, window.stride, startY, endY);
+            }
+        });
+    }
+
+    if (src.ok() && dst.ok()) {
+        dst.writeRows(*out[(blocks - 1) % 2], 1, (blocks - 1) * blockRows, rowsOf(blocks - 1));
+    }
+    return src.ok() && dst.ok();
+}
@@ -0,0 +1,98 @@
+/***********************************************
+ * Project: RaspberryConway
+ * File: fileboard.hpp
+ * By: ProgrammingIncluded
+ * Website: ProgrammingIncluded.github.io
+ * License: GNU GPLv3 (see LICENSE file)
+***********************************************/
+#ifndef FILEBOARD_HPP
+#define FILEBOARD_HPP
+
+#include "bitboard.hpp"
+#include "threadpool.hpp"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Bit packed board kept in a file, for boards larger than memory. Rows
+// are stored one after the other with no ghost words, each row holding
+// every plane of the row in turn. Rows are read and written with pread
+// and pwrite, a 32 bit Pi could not map a board this large.
+//
+// get and set go through a cache of one row, so setting cells in row
+// order (as the RLE loader does) writes each row once.
+class FileBoard {
+    public:
+        uint width;
+        uint height;
+        // Words per row of one plane
+        uint stride;
+        uint planes;
+
+        // Opens the file if it holds a board of this size, keeping its
+        // cells, or creates it with every cell dead. A file of any other
+        // size is left alone and the board is not opened.
+        FileBoard(const std::string &path, uint width, uint height, uint planes = 1);
+        ~FileBoard();
+
+        inline bool isOpen() const {
+            return this->fd >= 0;
+        }
+
+        // True if the file already held a board when opened
+        inline bool isResumed() const {
+            return this->resumed;
+        }
+
+        // Open and no read or write has failed, after a failure the cells
+        // can no longer be trusted
+        inline bool ok() const {
+            return this->fd >= 0 && !this->failed;
+        }
+
+        bool get(uint x, uint y, uint plane = 0);
+        void set(uint x, uint y, bool alive = true);
+
+        // Write back the cached row and drop it
+        void flush();
+
+        // Read window.height rows starting at row first into rows 0 and on
+        // of window. Rows past the board wrap on a torus, else are dead.
+        void readRows(BitBoard &window, long first, Boundary boundary);
+
+        // Write rows count rows of window starting at row from into rows y
+        // and on of the board
+        void writeRows(const BitBoard &window, uint from, uint y, uint count);
+
+        // Draw the cells from (x, y) to (x + view.width, y + view.height)
+        // into view, anything else in view is cleared
+        void render(BitBoard &view, uint x, uint y);
+
+    private:
+        int fd;
+        // Bytes per row including every plane
+        size_t rowBytes;
+        // Rows on their way to and from the file
+        std::vector<uint64_t> staging;
+
+        std::vector<uint64_t> cached;
+        long cachedY;
+        bool dirty;
+        bool failed;
+        bool resumed;
+
+        void cacheRow(uint y);
+
+        // Disallow copy constructor
+        FileBoard(const FileBoard&) = delete;
+};
+
+// Step src one generation into dst, which has the same size, streaming
+// blockRows rows at a time with a row of halo either side. The next block
+// is read and the last one written by one task of the pool while the
+// others step the current one, so disk and compute overlap. Returns false
+// and stops early if either file fails.
+bool stepFileBoard(FileBoard &src, FileBoard &dst, uint blockRows, Boundary boundary, ThreadPool &pool);
+
+#endif /* FILEBOARD_HPP */
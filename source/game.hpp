@@ -10,152 +10,191 @@
 #define GAME_HPP
 
 #include <cstring>
-#include <unordered_map>
-
-struct GenData {
-    char data;
-    GenData *ne;
-    GenData *nw;
-    GenData *sw;
-    GenData *se;
-    GenData *nn;
-    GenData *ee;
-    GenData *ww;
-    GenData *ss;
-    GenData *cc;
-
-    bool operator==(const GenData &g) const {
-        return 
-            data == g.data &&
-            ne == g.ne &&
-            nw == g.nw &&
-            sw == g.sw &&
-            se == g.se &&
-            nn == g.nn &&
-            ee == g.ee &&
-            ww == g.ww &&
-            ss == g.ss &&
-            cc == g.cc;
-    }
-};
+#include <cstdlib>
+#include <cstdint>
 
-#define se(i) ((bool)(i->data & 0b00000001))
-#define sw(i) ((bool)(i->data & 0b00000010))
-#define ne(i) ((bool)(i->data & 0b00000100))
-#define nw(i) ((bool)(i->data & 0b00001000))
-
-struct hash_fun {
-    std::size_t operator() (const GenData &d) const {
-        auto hasher = std::hash<GenData*>();
-        // No need to hash data since that is done by basis
-        return hasher(d.ne) ^ hasher(d.nw) ^ hasher(d.sw) ^ hasher(d.se) ^ hasher(d.nn) ^ hasher(d.ee)
-                ^ hasher(d.ww) ^ hasher(d.ss) ^ hasher(d.cc);
-    }
-};
+#include "rule.hpp"
 
-static std::unordered_map<GenData, GenData*, hash_fun> GEN_DATA_CACHE;
-static std::unordered_map<bool, GenData*> BASIS_CACHE;
+// A few functions to help with life
+// The rule masks index straight into the neighbour count, so each
+// instantiation is its own lookup table folded in at compile time
+template <uint BIRTH = CONWAY.birth, uint SURVIVE = CONWAY.survive>
+inline bool life (
+    bool nw, bool nn, bool ne,
+    bool ww, bool cc, bool ee,
+    bool sw, bool ss, bool se
+) {
+    uint count = nw + nn + ne + ww + ee + sw + ss + se;
+    return ((cc ? SURVIVE : BIRTH) >> count) & 1;
+}
 
-static GenData *NULLDATA;
+// Neighbour count of every bit of a word, one word per binary digit
+template <class W>
+struct LifeCount {
+    W ones;
+    W twos;
+    W fours;
+    W eights;
+};
 
+// Neighbours are summed with full adders into a binary count per bit.
+// Neighbour words must already be shifted so bit i lines up with cell i.
+// W is uint64_t or a vector of uint64_t lanes (see kernel_impl.hpp).
+// Kept static since kernels are built with different target flags and
+// must not share an out of line copy.
+template <class W>
+static inline LifeCount<W> countWord (
+    W nw, W nn, W ne,
+    W ww, W ee,
+    W sw, W ss, W se
+) {
+    // Each row reduced to a sum and carry bit
+    W topSum = nw ^ nn ^ ne;
+    W topCarry = (nw & nn) | (ne & (nw ^ nn));
+    W midSum = ww ^ ee;
+    W midCarry = ww & ee;
+    W botSum = sw ^ ss ^ se;
+    W botCarry = (sw & ss) | (se & (sw ^ ss));
+
+    // Ones column
+    W ones = topSum ^ midSum ^ botSum;
+    W onesCarry = (topSum & midSum) | (botSum & (topSum ^ midSum));
+
+    // Twos column, overflow into fours and eights
+    W twosSum = topCarry ^ midCarry ^ botCarry;
+    W twosCarry = (topCarry & midCarry) | (botCarry & (topCarry ^ midCarry));
+    W foursCarry = twosSum & onesCarry;
+
+    return {ones, twosSum ^ onesCarry, twosCarry ^ foursCarry, twosCarry & foursCarry};
+}
 
-inline GenData * setupNullData() {
-    if (NULLDATA != nullptr) {
-        return NULLDATA;
-    }
+// Word parallel version of life, every bit is its own cell.
+template <class W>
+static inline W lifeWord (
+    W nw, W nn, W ne,
+    W ww, W cc, W ee,
+    W sw, W ss, W se
+) {
+    LifeCount<W> count = countWord(nw, nn, ne, ww, ee, sw, ss, se);
 
-    NULLDATA = new GenData();
-    NULLDATA->data = 0;
-    NULLDATA->ne = NULLDATA;
-    NULLDATA->nw = NULLDATA;
-    NULLDATA->se = NULLDATA;
-    NULLDATA->sw = NULLDATA;
-    NULLDATA->cc = NULLDATA;
-    NULLDATA->ee = NULLDATA;
-    NULLDATA->ww = NULLDATA;
-    NULLDATA->nn = NULLDATA;
-    NULLDATA->ss = NULLDATA;
-    return NULLDATA;
+    // Alive with count of 3, or 2 if already alive. Eight neighbours is
+    // dead either way so any count of four or more will do.
+    return count.twos & ~(count.fours | count.eights) & (count.ones | cc);
 }
 
-inline GenData *getBasis(bool data) {
-    auto res = BASIS_CACHE.find(data);
-    if (res != BASIS_CACHE.end())
-        return res->second;
-    
-    GenData *val = new GenData();
-    val->data = data;
-    val->ne = NULLDATA;
-    val->nw = NULLDATA;
-    val->se = NULLDATA;
-    val->sw = NULLDATA;
-
-    val->cc = NULLDATA;
-    val->ee = NULLDATA;
-    val->ww = NULLDATA;
-    val->nn = NULLDATA;
-    val->ss = NULLDATA;
-    return val;
+// Truth table of a rule over the count bits and the cell, bit i is the
+// next state when bits 0 to 3 of i are the count and bit 4 the cell.
+// Counts past eight never happen and copy the count without the eights
+// bit, so rules that treat 0 and 8 alike do not depend on the eights.
+constexpr uint lifeTableBit(uint mask, uint n) {
+    return (mask >> (n > 8 ? n - 8 : n)) & 1;
 }
 
-// Memorization of data
-// returns true if new pointer created
-inline bool getGenData(GenData **newLoc, GenData data) {
-    auto res = GEN_DATA_CACHE.find(data);
-    if (res != GEN_DATA_CACHE.end()) {
-        *newLoc = res->second;
-        return true;
+constexpr uint32_t lifeTable(uint birth, uint survive, uint n = 0) {
+    return (n == 16) ? 0 :
+        (lifeTableBit(birth, n) << n) |
+        (lifeTableBit(survive, n) << (n + 16)) |
+        lifeTable(birth, survive, n + 1);
+}
+
+// Boolean function of VARS words given as a truth table, bit i of table
+// is the result when bit k of i matches vars[k]. With a constant table
+// every split the result does not depend on folds away, leaving a few
+// ands and ors.
+template <uint VARS>
+struct TruthTable {
+    template <class W>
+    __attribute__((always_inline)) static inline W eval(uint32_t table, const W *vars) {
+        uint half = 1 << (VARS - 1);
+        uint32_t mask = ((uint64_t) 1 << half) - 1;
+        uint32_t lo = table & mask;
+        uint32_t hi = (table >> half) & mask;
+
+        if (lo == hi) {
+            return TruthTable<VARS - 1>::eval(lo, vars);
+        }
+
+        W v = vars[VARS - 1];
+        if (hi == 0) {
+            return ~v & TruthTable<VARS - 1>::eval(lo, vars);
+        }
+        if (lo == 0) {
+            return v & TruthTable<VARS - 1>::eval(hi, vars);
+        }
+        return (v & TruthTable<VARS - 1>::eval(hi, vars)) | (~v & TruthTable<VARS - 1>::eval(lo, vars));
     }
+};
 
-    GenData *val = (GenData *) malloc(sizeof(GenData));
-    memcpy(val, (void *) &data, sizeof(GenData));
-    *newLoc = val;
-    GEN_DATA_CACHE[data] = val;
-    return false;
-}
+template <>
+struct TruthTable<0> {
+    template <class W>
+    __attribute__((always_inline)) static inline W eval(uint32_t table, const W *vars) {
+        W zero = vars[0] & ~vars[0];
+        return (table & 1) ? ~zero : zero;
+    }
+};
 
-// A few functions to help with life
-inline bool life (
-    bool nw, bool nn, bool ne,
-    bool ww, bool cc, bool ee,
-    bool sw, bool ss, bool se
+// lifeWord for a rule known at compile time
+template <uint BIRTH, uint SURVIVE, class W>
+static inline W lifeWordRule (
+    W nw, W nn, W ne,
+    W ww, W cc, W ee,
+    W sw, W ss, W se
 ) {
-    uint count = nw + nn + ne + ww + ee + sw + ss + se;
-    return (count == 2) ? cc : (count == 3);
+    if (BIRTH == CONWAY.birth && SURVIVE == CONWAY.survive) {
+        return lifeWord(nw, nn, ne, ww, cc, ee, sw, ss, se);
+    }
+
+    static constexpr uint32_t TABLE = lifeTable(BIRTH, SURVIVE);
+    LifeCount<W> count = countWord(nw, nn, ne, ww, ee, sw, ss, se);
+    W vars[] = {count.ones, count.twos, count.fours, count.eights, cc};
+    return TruthTable<5>::eval(TABLE, vars);
 }
 
-// Calculate life rules for a 4x4 gen data
-inline char life_4 (
-    GenData *nw, GenData *ne,
-    GenData *sw, GenData *se
+// lifeWord for any rule, each count in the rule is matched in turn
+template <class W>
+static inline W lifeWordGeneric (
+    W nw, W nn, W ne,
+    W ww, W cc, W ee,
+    W sw, W ss, W se,
+    uint birth, uint survive
 ) {
-    char data = 0;
-    // Set data bits for new center
-    data |= life (
-                nw(nw), ne(nw), nw(ne),
-                sw(nw), se(nw), sw(ne),
-                nw(sw), ne(sw), nw(se)
-            ) << 3; // nw
-
-    data |= life(
-                ne(nw), nw(ne), ne(ne),
-                se(nw), sw(ne), se(ne),
-                ne(sw), nw(se), ne(se)
-            )<< 2; // ne
-
-    data |= life(
-                sw(nw), se(nw), sw(ne),
-                nw(sw), ne(sw), nw(se),
-                sw(sw), se(sw), sw(se)
-            ) << 1; // sw 
-    data |= life (
-                se(nw), sw(ne), se(ne),
-                ne(sw), nw(se), ne(se),
-                se(sw), sw(se), se(se)
-            ); // se
-    return data;
+    LifeCount<W> count = countWord(nw, nn, ne, ww, ee, sw, ss, se);
+    W born = cc & ~cc;
+    W kept = born;
+
+    for (uint n = 0; n <= 8; ++n) {
+        if (((birth | survive) >> n & 1) == 0) {
+            continue;
+        }
+
+        // Cells whose count is exactly n
+        W match = (n & 1 ? count.ones : ~count.ones) &
+            (n & 2 ? count.twos : ~count.twos) &
+            (n & 4 ? count.fours : ~count.fours) &
+            (n & 8 ? count.eights : ~count.eights);
+
+        if (birth >> n & 1) {
+            born |= match;
+        }
+        if (survive >> n & 1) {
+            kept |= match;
+        }
+    }
+
+    return (cc & kept) | (~cc & born);
 }
 
+// Align neighbouring cells of a packed word with the cell itself.
+// prev and next are the words directly before and after in the row.
+template <class W>
+static inline W westOf(W word, W prev) {
+    return (word << 1) | (prev >> 63);
+}
 
+template <class W>
+static inline W eastOf(W word, W next) {
+    return (word >> 1) | (next << 63);
+}
 
 #endif /* GAME_HPP */
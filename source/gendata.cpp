@@ -0,0 +1,486 @@
+/***********************************************
+ * Project: RaspberryConway
+ * File: gendata.cpp
+ * By: ProgrammingIncluded
+ * Website: ProgrammingIncluded.github.io
+ * License: GNU GPLv3 (see LICENSE file)
+***********************************************/
+
+#include "gendata.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+#include <new>
+
+#include <sys/mman.h>
+
+// Blocks live in fixed size pages so they never move as the arena grows,
+// and are found from their id by page and index. Pages are mapped from
+// the system directly so the ones a collection frees can be given back.
+static const uint PAGE_SHIFT = 12;
+static const uint PAGE_SIZE = 1 << PAGE_SHIFT;
+static const size_t PAGE_BYTES = PAGE_SIZE * sizeof(GenData);
+
+// The memo is split by the top bits of the hash into tables with a lock
+// each, so threads making blocks seldom wait on each other
+static const uint SHARD_BITS = 4;
+static const uint SHARDS = 1 << SHARD_BITS;
+
+static const uint FIRST_CAPACITY = (1 << 16) / SHARDS;
+
+// Pages are reserved up front so byId never sees the list move
+static const uint MAX_PAGES = 1 << (32 - PAGE_SHIFT);
+static std::vector<GenData *> PAGES;
+// Held while handing out ids
+static std::mutex ARENA_LOCK;
+// Whether ARENA_LOCK and the locks of the shards are taken at all
+static bool LOCKING = true;
+static uint32_t NEXT_ID = 0;
+// Ids below NEXT_ID freed by the last collection, lowest last
+static std::vector<uint32_t> FREE_IDS;
+
+static std::vector<GenData **> ROOTS;
+static size_t BUDGET = 0;
+// memoBytes the next collection waits for, twice what the last one left
+// if that is over the budget, so blocks in use past the budget do not
+// set off a collection every step
+static size_t THRESHOLD = 0;
+static bool WARNED = false;
+static uint STEP_EXPONENT = 0;
+
+struct Shard {
+    std::mutex lock;
+    MemoTable table;
+};
+
+static Shard GEN_DATA_CACHE[SHARDS];
+
+static GenData *NULLDATA;
+
+// Never an id, so the key of a leaf never matches four quadrants
+static const uint32_t LEAF_KEY = UINT32_MAX;
+
+static_assert(sizeof(GenData) <= 64, "Blocks are meant to fit a cache line");
+
+// Murmur3 finaliser, every input bit reaches every output bit
+static inline uint64_t mix(uint64_t h) {
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return h;
+}
+
+// Quadrants are packed in order, so swapping two of them changes the hash
+static inline uint64_t hashKey(const uint32_t key[4]) {
+    uint64_t top = ((uint64_t) key[0] << 32) | key[1];
+    uint64_t bottom = ((uint64_t) key[2] << 32) | key[3];
+    return mix(mix(top) ^ bottom);
+}
+
+MemoTable::MemoTable() {
+    this->slots.resize(FIRST_CAPACITY);
+    this->used = 0;
+    this->resetCounters();
+}
+
+void MemoTable::reset(size_t entries) {
+    size_t capacity = FIRST_CAPACITY;
+    while (capacity < entries * 2) {
+        capacity *= 2;
+    }
+
+    std::vector<Slot>(capacity).swap(this->slots);
+    this->used = 0;
+}
+
+uint32_t &MemoTable::lookup(const uint32_t key[4], uint64_t hash) {
+    if ((this->used + 1) * 2 > this->slots.size()) {
+        this->grow();
+    }
+
+    size_t mask = this->slots.size() - 1;
+    size_t i = hash & mask;
+    uint probe = 1;
+    // Ids start at 1, so an empty slot has id 0
+    while (this->slots[i].id != 0 && memcmp(this->slots[i].key, key, sizeof(this->slots[i].key)) != 0) {
+        i = (i + 1) & mask;
+        ++probe;
+    }
+
+    ++this->lookups;
+    this->probes += probe;
+    this->longest = std::max(this->longest, probe);
+
+    Slot &slot = this->slots[i];
+    if (slot.id == 0) {
+        memcpy(slot.key, key, sizeof(slot.key));
+        ++this->used;
+    }
+    return slot.id;
+}
+
+void MemoTable::grow() {
+    std::vector<Slot> old(this->slots.size() * 2);
+    old.swap(this->slots);
+
+    size_t mask = this->slots.size() - 1;
+    for (const Slot &slot : old) {
+        if (slot.id == 0) {
+            continue;
+        }
+        size_t i = hashKey(slot.key) & mask;
+        while (this->slots[i].id != 0) {
+            i = (i + 1) & mask;
+        }
+        this->slots[i] = slot;
+    }
+}
+
+double MemoTable::meanProbes() const {
+    return (this->lookups == 0) ? 0 : (double) this->probes / this->lookups;
+}
+
+uint MemoTable::longestProbe() const {
+    return this->longest;
+}
+
+void MemoTable::resetCounters() {
+    this->lookups = 0;
+    this->probes = 0;
+    this->longest = 0;
+}
+
+static inline GenData *byId(uint32_t id) {
+    return PAGES[id >> PAGE_SHIFT] + (id & (PAGE_SIZE - 1));
+}
+
+// Next block of the arena, with every field dead. Freed blocks are
+// handed out again before the arena grows.
+static GenData *allocate() {
+    uint32_t id;
+    {
+        std::unique_lock<std::mutex> guard(ARENA_LOCK, std::defer_lock);
+        if (LOCKING) {
+            guard.lock();
+        }
+        if (!FREE_IDS.empty()) {
+            id = FREE_IDS.back();
+            FREE_IDS.pop_back();
+        } else {
+            id = NEXT_ID++;
+            if ((id & (PAGE_SIZE - 1)) == 0) {
+                void *page = mmap(nullptr, PAGE_BYTES, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+                if (page == MAP_FAILED) {
+                    throw std::bad_alloc();
+                }
+                PAGES.reserve(MAX_PAGES);
+                PAGES.push_back((GenData *) page);
+            }
+        }
+    }
+
+    GenData *val = byId(id);
+    val->cells = 0;
+    val->level = 0;
+    for (uint i = 0; i < RESULT_SLOTS; ++i) {
+        val->steps[i].store(NO_STEP, std::memory_order_relaxed);
+    }
+    val->id = id;
+    val->nw = NULLDATA;
+    val->ne = NULLDATA;
+    val->sw = NULLDATA;
+    val->se = NULLDATA;
+    return val;
+}
+
+GenData *setupNullData() {
+    if (NULLDATA != nullptr) {
+        return NULLDATA;
+    }
+
+    // Takes id 0 and points at itself
+    NULLDATA = allocate();
+    NULLDATA->nw = NULLDATA;
+    NULLDATA->ne = NULLDATA;
+    NULLDATA->sw = NULLDATA;
+    NULLDATA->se = NULLDATA;
+    return NULLDATA;
+}
+
+// Leaves are found by their cells, in place of the first two quadrants
+static inline void leafKey(uint32_t key[4], uint64_t cells) {
+    key[0] = cells >> 32;
+    key[1] = (uint32_t) cells;
+    key[2] = LEAF_KEY;
+    key[3] = LEAF_KEY;
+}
+
+// Block with the given key, made by make if there is none yet. Returns
+// true if it already existed. The shard stays locked until the new block
+// is filled in, so no other thread sees it half made.
+template <class F>
+static inline bool intern(GenData **found, const uint32_t key[4], const F &make) {
+    uint64_t hash = hashKey(key);
+    Shard &shard = GEN_DATA_CACHE[hash >> (64 - SHARD_BITS)];
+    std::unique_lock<std::mutex> guard(shard.lock, std::defer_lock);
+    if (LOCKING) {
+        guard.lock();
+    }
+
+    uint32_t &id = shard.table.lookup(key, hash);
+    if (id != 0) {
+        *found = byId(id);
+        return true;
+    }
+
+    GenData *val = allocate();
+    make(val);
+    id = val->id;
+    *found = val;
+    return false;
+}
+
+GenData *getLeaf(uint64_t cells) {
+    // Dead is NULLDATA at every size, so dead blocks compare equal
+    setupNullData();
+    if (cells == 0) {
+        return NULLDATA;
+    }
+
+    uint32_t key[4];
+    leafKey(key, cells);
+    GenData *found;
+    intern(&found, key, [cells](GenData *val) {
+        val->cells = cells;
+        val->level = LEAF_LEVEL;
+    });
+    return found;
+}
+
+bool getGenData(GenData **found, GenData *nw, GenData *ne, GenData *sw, GenData *se) {
+    setupNullData();
+
+    // Dead at every size is the one block
+    if (nw == NULLDATA && ne == NULLDATA && sw == NULLDATA && se == NULLDATA) {
+        *found = NULLDATA;
+        return true;
+    }
+
+    uint32_t key[4] = {nw->id, ne->id, sw->id, se->id};
+    return intern(found, key, [nw, ne, sw, se](GenData *val) {
+        val->nw = nw;
+        val->ne = ne;
+        val->sw = sw;
+        val->se = se;
+        // Any quadrant but NULLDATA has the level below
+        val->level = 1 + std::max(std::max(nw->level, ne->level), std::max(sw->level, se->level));
+    });
+}
+
+void setMemoLocking(bool locking) {
+    LOCKING = locking;
+}
+
+uint stepExponent() {
+    return STEP_EXPONENT;
+}
+
+void setStepExponent(uint exponent) {
+    STEP_EXPONENT = exponent;
+}
+
+// Exponent a result of node is stepped with now
+static inline uint8_t currentStep(const GenData *node) {
+    return std::min<uint>(STEP_EXPONENT, node->level - 2);
+}
+
+GenData *getResult(GenData *node) {
+    // NULLDATA steps to itself whatever the exponent
+    if (node == NULLDATA) {
+        return NULLDATA;
+    }
+
+    // The result is stored before its step, so a step that matches has
+    // the result to go with it
+    uint8_t step = currentStep(node);
+    uint slot = step % RESULT_SLOTS;
+    if (node->steps[slot].load(std::memory_order_acquire) != step) {
+        return nullptr;
+    }
+    return byId(node->results[slot].load(std::memory_order_relaxed));
+}
+
+void setResult(GenData *node, GenData *result) {
+    // Every thread setting it this step stores the same pair
+    uint8_t step = currentStep(node);
+    uint slot = step % RESULT_SLOTS;
+    node->results[slot].store(result->id, std::memory_order_relaxed);
+    node->steps[slot].store(step, std::memory_order_release);
+}
+
+void printMemoStats() {
+    // Keys are spread evenly over the shards, so the mean of their means
+    // is close enough
+    size_t size = 0;
+    size_t capacity = 0;
+    double probes = 0;
+    uint longest = 0;
+    for (Shard &shard : GEN_DATA_CACHE) {
+        size += shard.table.size();
+        capacity += shard.table.capacity();
+        probes += shard.table.meanProbes() / SHARDS;
+        longest = std::max(longest, shard.table.longestProbe());
+        shard.table.resetCounters();
+    }
+
+    std::cout << "Memo: " << size << "/" << capacity
+              << " load: " << (double) size / capacity
+              << " probes mean: " << probes
+              << " longest: " << longest << std::endl;
+}
+
+void addRoot(GenData **root) {
+    ROOTS.push_back(root);
+}
+
+void removeRoot(GenData **root) {
+    ROOTS.erase(std::remove(ROOTS.begin(), ROOTS.end(), root), ROOTS.end());
+}
+
+size_t memoBytes() {
+    size_t bytes = (NEXT_ID - FREE_IDS.size()) * sizeof(GenData);
+    for (Shard &shard : GEN_DATA_CACHE) {
+        bytes += shard.table.bytes();
+    }
+    return bytes;
+}
+
+void setMemoryBudget(size_t bytes) {
+    BUDGET = bytes;
+    THRESHOLD = bytes;
+}
+
+// Flag every block reachable from the roots, and from their results if
+// they are kept
+static void mark(std::vector<bool> &marked, bool keepResults) {
+    marked.assign(NEXT_ID, false);
+    std::vector<GenData *> stack;
+
+    auto visit = [&marked, &stack](GenData *node) {
+        if (node != nullptr && !marked[node->id]) {
+            marked[node->id] = true;
+            stack.push_back(node);
+        }
+    };
+
+    visit(NULLDATA);
+    for (GenData **root : ROOTS) {
+        visit(*root);
+    }
+
+    while (!stack.empty()) {
+        GenData *node = stack.back();
+        stack.pop_back();
+        visit(node->nw);
+        visit(node->ne);
+        visit(node->sw);
+        visit(node->se);
+        for (uint i = 0; i < RESULT_SLOTS && keepResults; ++i) {
+            if (node->steps[i] != NO_STEP) {
+                visit(byId(node->results[i]));
+            }
+        }
+    }
+}
+
+// Free every block that is not marked and put the rest back in the
+// memo table. The arena ends after the last block kept and the pages past
+// it are unmapped, pages with no blocks kept before it are left mapped but
+// handed back to the system until their ids are used again.
+static void sweep(const std::vector<bool> &marked, bool keepResults) {
+    size_t live = std::count(marked.begin(), marked.end(), true);
+    for (Shard &shard : GEN_DATA_CACHE) {
+        shard.table.reset(live / SHARDS);
+    }
+    FREE_IDS.clear();
+
+    // NULLDATA is always marked
+    while (!marked[NEXT_ID - 1]) {
+        --NEXT_ID;
+    }
+    size_t pages = (NEXT_ID + PAGE_SIZE - 1) >> PAGE_SHIFT;
+    for (size_t page = pages; page < PAGES.size(); ++page) {
+        munmap(PAGES[page], PAGE_BYTES);
+    }
+    PAGES.resize(pages);
+
+    // Blocks kept on each page, NULLDATA on the first
+    std::vector<uint> kept(pages, 0);
+    kept[0] = 1;
+    for (uint32_t id = NEXT_ID - 1; id > 0; --id) {
+        if (!marked[id]) {
+            FREE_IDS.push_back(id);
+            continue;
+        }
+        ++kept[id >> PAGE_SHIFT];
+
+        GenData *node = byId(id);
+        for (uint i = 0; i < RESULT_SLOTS && !keepResults; ++i) {
+            node->steps[i] = NO_STEP;
+        }
+
+        uint32_t key[4] = {node->nw->id, node->ne->id, node->sw->id, node->se->id};
+        if (node->level == LEAF_LEVEL) {
+            leafKey(key, node->cells);
+        }
+        uint64_t hash = hashKey(key);
+        GEN_DATA_CACHE[hash >> (64 - SHARD_BITS)].table.lookup(key, hash) = id;
+    }
+
+    // Blocks are filled in whole when handed out again, so the zero
+    // pages the system maps back in are fine
+    for (size_t page = 0; page < pages; ++page) {
+        if (kept[page] == 0) {
+            madvise(PAGES[page], PAGE_BYTES, MADV_DONTNEED);
+        }
+    }
+}
+
+void collectGarbage() {
+    if (BUDGET == 0 || memoBytes() <= THRESHOLD) {
+        return;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    size_t before = NEXT_ID - FREE_IDS.size();
+
+    std::vector<bool> marked;
+    mark(marked, true);
+    sweep(marked, true);
+
+    bool dropped = false;
+    if (memoBytes() > BUDGET / 2) {
+        mark(marked, false);
+        sweep(marked, false);
+        dropped = true;
+    }
+
+    size_t after = NEXT_ID - FREE_IDS.size();
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "Collected " << before - after << " blocks, " << after << " left"
+              << (dropped ? ", results dropped" : "") << ", paused " << ms << " ms" << std::endl;
+
+    size_t left = memoBytes();
+    THRESHOLD = std::max(BUDGET, 2 * left);
+    if (left > BUDGET && !WARNED) {
+        WARNED = true;
+        std::cout << "The " << left / (1 << 20) << " MB of blocks in use do not fit the memory budget of "
+                  << BUDGET / (1 << 20) << " MB, collecting again at " << THRESHOLD / (1 << 20)
+                  << " MB. Raise --memory" << std::endl;
+    }
+}
@@ -0,0 +1,172 @@
+/***********************************************
+ * Project: RaspberryConway
+ * File: gendata.hpp
+ * By: ProgrammingIncluded
+ * Website: ProgrammingIncluded.github.io
+ * License: GNU GPLv3 (see LICENSE file)
+ * Inspired by: https://dotat.at/prog/life/hashlife.c
+***********************************************/
+#ifndef GENDATA_HPP
+#define GENDATA_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+#include "game.hpp"
+
+// Results kept on each block, for as many exponents at once. An exponent
+// takes the slot exponent % RESULT_SLOTS, so advance() with up to three
+// set bits keeps the results of every step of a frame for the next one.
+const uint RESULT_SLOTS = 3;
+
+// Block of 2^level cells a side. Blocks are shared by every part of the
+// plane with the same cells, with only one block for any four quadrants,
+// so a pattern takes memory in proportion to its distinct parts. An 8x8
+// leaf keeps its cells in a word, bigger blocks are made of four smaller
+// ones. Blocks never change once made, apart from filling in results.
+// Results are ids rather than pointers so a block fits a cache line.
+struct GenData {
+    // Cells of a leaf, x, y in bit y * 8 + x as in a MortonBoard block
+    uint64_t cells;
+    // 2^level cells a side, 0 for NULLDATA which is every size
+    uint8_t level;
+    // Exponent the result in each slot was stepped with, stored after
+    // it, NO_STEP for an empty slot
+    std::atomic<uint8_t> steps[RESULT_SLOTS];
+    // Index in the arena, 0 is NULLDATA
+    uint32_t id;
+    // Id of the middle half of the block 2^steps[i] generations on,
+    // unused on leaves. Go through getResult and setResult, which only
+    // hand back a result stepped with the current exponent. Threads
+    // stepping the same block race to fill it in with the same block.
+    std::atomic<uint32_t> results[RESULT_SLOTS];
+    GenData *nw;
+    GenData *ne;
+    GenData *sw;
+    GenData *se;
+};
+
+// Step of an empty result slot
+const uint8_t NO_STEP = UINT8_MAX;
+
+// Level and side of a leaf
+const uint LEAF_LEVEL = 3;
+const uint LEAF_SIZE = 1 << LEAF_LEVEL;
+
+// Open addressing table from the ids of the four quadrants of a block, or
+// the cells of a leaf, to the id of the block. Slots keep the whole key
+// next to the value and two fit a cache line, so a lookup that finds its
+// key in the first few slots touches one line. Probes are linear over a
+// power of two slots, which are doubled before they are half full. Not
+// thread safe, the memo is split into several tables each with its own
+// lock.
+class MemoTable {
+    public:
+        MemoTable();
+
+        // Drop every entry, leaving room for at least entries of them
+        void reset(size_t entries);
+
+        // Id of the block with quadrants key and the given hash of it, a
+        // new slot set to 0 if there is none. The reference is good until
+        // the next lookup.
+        uint32_t &lookup(const uint32_t key[4], uint64_t hash);
+
+        inline size_t size() const {
+            return this->used;
+        }
+
+        inline size_t capacity() const {
+            return this->slots.size();
+        }
+
+        inline size_t bytes() const {
+            return this->slots.size() * sizeof(Slot);
+        }
+
+        // Average and longest slots looked at per lookup since the last
+        // reset
+        double meanProbes() const;
+        uint longestProbe() const;
+        void resetCounters();
+
+    private:
+        struct alignas(32) Slot {
+            uint32_t key[4];
+            uint32_t id;
+        };
+
+        std::vector<Slot> slots;
+        size_t used;
+        uint64_t lookups;
+        uint64_t probes;
+        uint longest;
+
+        void grow();
+
+        // Disallow copy constructor
+        MemoTable(const MemoTable&) = delete;
+};
+
+// Block with every cell dead, its own quadrants at every size
+GenData *setupNullData();
+
+// Shared leaf with the given cells
+GenData *getLeaf(uint64_t cells);
+
+// Memorization of data, the shared block with the given quadrants.
+// Returns true if it already existed. A new block has no result yet.
+// Blocks can be made by several threads at once, each set of quadrants
+// still gets one block.
+bool getGenData(GenData **found, GenData *nw, GenData *ne, GenData *sw, GenData *se);
+
+inline GenData *join(GenData *nw, GenData *ne, GenData *sw, GenData *se) {
+    GenData *found;
+    getGenData(&found, nw, ne, sw, se);
+    return found;
+}
+
+// Blocks are only safe to make from several threads at once while the
+// memo is locked, which it is unless turned off. A single thread can
+// leave the locks out, which saves about 15% of a step.
+void setMemoLocking(bool locking);
+
+// Generations stepped by a result are 2^stepExponent(), or 2^(level - 2)
+// for blocks too small to step that far. Changing it costs nothing, each
+// result remembers the exponent it was stepped with and is kept next to
+// those of other exponents in their own slots, see RESULT_SLOTS. Blocks
+// no bigger than 2^(exponent + 2) for the smaller of the two exponents
+// step the same either way and share one result. Must not change in the
+// middle of a step.
+uint stepExponent();
+void setStepExponent(uint exponent);
+
+// Result of node for the current exponent, nullptr if there is none yet
+GenData *getResult(GenData *node);
+void setResult(GenData *node, GenData *result);
+
+// Print the size, load factor and probe lengths of the memo table
+void printMemoStats();
+
+// Blocks are only freed by collectGarbage, which keeps every block that
+// can be reached from a root. Roots are pointers to a block, such as the
+// root of a QuadTree, followed when the collection runs.
+void addRoot(GenData **root);
+void removeRoot(GenData **root);
+
+// Bytes of blocks in use and of the memo table
+size_t memoBytes();
+
+// Bytes collectGarbage keeps memoBytes under, 0 for no limit
+void setMemoryBudget(size_t bytes);
+
+// Free unreachable blocks if memoBytes is over the budget. Results are
+// kept unless that is not enough to get under half of the budget, in
+// which case they are dropped as well and worked out again as needed.
+// If the blocks left are still over the budget, the next collection waits
+// until memoBytes is twice what they took, and a warning is printed once.
+// Must not run in the middle of a step, only roots are kept.
+void collectGarbage();
+
+#endif /* GENDATA_HPP */
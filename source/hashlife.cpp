@@ -7,9 +7,14 @@
 ***********************************************/
 
 #include "app.hpp"
+#include "gendata.hpp"
+#include "kernel.hpp"
 #include "quadtree.hpp"
 #include "rle_loader.hpp"
+#include "settings.hpp"
+#include "threadpool.hpp"
 
+#include <algorithm>
 #include <iostream>
 #include <cstring>
 #include <chrono>
@@ -28,6 +33,10 @@ static uint BOARD_TIMES_Y = 1;
 // ms per frame
 static const double MSPF = 200.0;
 
+// Generations per frame go up to 2^MAX_STEP_EXPONENT, past that the
+// root would outgrow the coordinates
+static const uint MAX_STEP_EXPONENT = 48;
+
 
 // TODO: Probably want graphics card to do this
 // Virtualboard size + padding should be a multiple of screen size 
@@ -38,44 +47,20 @@ inline void drawBoard(QuadTree &field) {
             // Transform to game space, negative bias by one for even pixel screens
             lint transX = POS_X + x - SCREEN_X / 2;
             lint transY = POS_Y + y - SCREEN_Y / 2;
-            DISPLAY[x + (y * SCREEN_X)] = 0xFFFFFFFF * field.getNextGenPixel(transX, transY);
+            DISPLAY[x + (y * SCREEN_X)] = 0xFFFFFFFF * field.getPixel(transX, transY);
         }
     }
 }
 
 
-// Runs one iteration of the board game
-inline void updateBoard() {
-    // Naive implementation
-    // for (uint y=0; y < BOARD_Y; y += 1) {
-    //     for(uint x=0; x < BOARD_X; x += 1) {
-    //         // Current cell
-    //         bool cur = virtualBoard[x + (y * BOARD_X)];
-    //         // Get neighbors of tiles
-    //         bool n0 = getTile(x + 1, y, virtualBoard);
-    //         bool n1 = getTile(x + 1, y + 1, virtualBoard);
-    //         bool n2 = getTile(x + 1, y - 1, virtualBoard);
-    //         bool n3 = getTile(x - 1, y + 1, virtualBoard);
-    //         bool n4 = getTile(x - 1, y - 1, virtualBoard);
-    //         bool n5 = getTile(x - 1, y, virtualBoard);
-    //         bool n6 = getTile(x, y + 1, virtualBoard);
-    //         bool n7 = getTile(x, y - 1, virtualBoard);
-
-    //         // Check if alive
-    //         uint res = n0 + n1 + n2 + n3 + n4 + n5 + n6 + n7;
-
-    //         if (cur) {
-    //             bool alive = (2 <= res && res <= 3);
-    //             BOARD_BUFFER[x + (y * BOARD_X)] = alive * 0xFFFFFFFF;
-    //         } else {
-    //             bool alive = (res == 3);
-    //             BOARD_BUFFER[x + (y * BOARD_X)] = alive * 0xFFFFFFFF;
-    //         }
-    //     }
-    // }
-    // // Update previous virtualBoard to new buffer
-    // memcpy(virtualBoard, BOARD_BUFFER, sizeof(bool) * BOARD_X * BOARD_Y);
-    // memset(BOARD_BUFFER, 0, BOARD_X * BOARD_Y * sizeof(bool));
+// Runs one iteration of the board game, SETTINGS.generations of them if
+// more than one is asked for and 2^stepExponent() otherwise
+inline void updateBoard(QuadTree &field, ThreadPool &pool) {
+    if (SETTINGS.generations > 1) {
+        field.advance(SETTINGS.generations, &pool);
+    } else {
+        field.nextGeneration(&pool);
+    }
 }
 
 void parseInput(char key) {
@@ -110,6 +95,17 @@ void parseInput(char key) {
             // LEFT
             POS_X = (POS_X == 0) ? POS_X : POS_X - 10;
             break;
+        case '=':
+        case '+':
+            // Twice the generations per frame
+            setStepExponent(std::min(stepExponent() + 1, MAX_STEP_EXPONENT));
+            std::cout << "Step: 2^" << stepExponent() << std::endl;
+            break;
+        case '-':
+            // Half the generations per frame
+            setStepExponent(stepExponent() == 0 ? 0 : stepExponent() - 1);
+            std::cout << "Step: 2^" << stepExponent() << std::endl;
+            break;
     }
 }
 
@@ -120,49 +116,107 @@ void spawnGlider(QuadTree &field, lint x, lint y) {
 }
 
 int main(int argc, char *argv[]) {
-    startApp();
+    parseSettings(argc, argv);
+
+    // Leaves hold one bit a cell and see the eight cells around them
+    if (SETTINGS.rule.states != 2 || SETTINGS.ltl.radius > 0) {
+        std::cout << "Hashlife only supports two state B/S rules such as B3/S23" << std::endl;
+        return 1;
+    }
+    setLifeRule(SETTINGS.rule);
+    std::cout << "Rule: " << ruleString(lifeKernel().rule) << std::endl;
+
+    if (!SETTINGS.headless) {
+        startApp();
+    }
 
     std::cout << "Screen Size X: " << SCREEN_X << std::endl;
     std::cout << "Screen Size Y: " << SCREEN_Y << std::endl;
 
+    setMemoryBudget((size_t) SETTINGS.memory << 20);
+    std::cout << "Memory: " << SETTINGS.memory << " MB" << std::endl;
+
+    // Big blocks are stepped across the pool
+    ThreadPool pool(SETTINGS.threads);
+    std::cout << "Threads: " << pool.size() << std::endl;
+
+    setStepExponent(std::min(SETTINGS.step, MAX_STEP_EXPONENT));
+    if (SETTINGS.generations > 1) {
+        std::cout << "Generations per frame: " << SETTINGS.generations << std::endl;
+    } else {
+        std::cout << "Step: 2^" << stepExponent() << std::endl;
+    }
+
     QuadTree field;
 
-    // loadRLE("gosperglidergun.rle", &field);
-    spawnGlider(field, 0, 0);
-    field.nextGeneration(field.root);
+    if (SETTINGS.pattern.empty()) {
+        spawnGlider(field, 0, 0);
+    } else if (!loadRLE(SETTINGS.pattern, &field)) {
+        std::cout << "Could not load pattern: " << SETTINGS.pattern << std::endl;
+        return 1;
+    }
 
 
     // FPS Logic: https://stackoverflow.com/questions/38730273/how-to-limit-fps-in-a-loop-with-c
     std::chrono::system_clock::time_point a = std::chrono::system_clock::now();
     std::chrono::system_clock::time_point b = std::chrono::system_clock::now();
 
+    // Frames stepped and time spent stepping them, printed when the loop
+    // ends after SETTINGS.frames
+    uint frame = 0;
+    double stepMs = 0;
+
     // Game Loop
     for(;;) {
-        a = std::chrono::system_clock::now();
-        std::chrono::duration<double, std::milli> work_time = a - b;
-
-        if (work_time.count() < MSPF)
-        {
-            std::chrono::duration<double, std::milli> delta_ms(MSPF - work_time.count());
-            auto delta_ms_duration = std::chrono::duration_cast<std::chrono::milliseconds>(delta_ms);
-            std::this_thread::sleep_for(std::chrono::milliseconds(delta_ms_duration.count()));
+        // Headless runs are for timing, so go as fast as possible
+        if (!SETTINGS.headless) {
+            a = std::chrono::system_clock::now();
+            std::chrono::duration<double, std::milli> work_time = a - b;
+
+            if (work_time.count() < MSPF)
+            {
+                std::chrono::duration<double, std::milli> delta_ms(MSPF - work_time.count());
+                auto delta_ms_duration = std::chrono::duration_cast<std::chrono::milliseconds>(delta_ms);
+                std::this_thread::sleep_for(std::chrono::milliseconds(delta_ms_duration.count()));
+            }
+
+            b = std::chrono::system_clock::now();
+
+            #if DEBUG
+                std::chrono::duration<double, std::milli> sleep_time = b - a;
+                std::cout << "MS per Frame: " << sleep_time.count() << std::endl;
+            #endif
+
+            // Map board to display
+            parseInput(getKeyPress());
         }
 
-        b = std::chrono::system_clock::now();
+        // Update board
+        auto start = std::chrono::steady_clock::now();
+        updateBoard(field, pool);
+        stepMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
 
-        #if DEBUG
-            std::chrono::duration<double, std::milli> sleep_time = b - a;
-            std::cout << "MS per Frame: " << sleep_time.count() << std::endl;
-        #endif
+        if (SETTINGS.stats) {
+            std::cout << "Generation: " << field.generation << " step ms: " << stepMs / (frame + 1) << std::endl;
+            printMemoStats();
+        }
+
+        if (SETTINGS.frames != 0 && ++frame >= SETTINGS.frames) {
+            break;
+        }
+        if (SETTINGS.headless) {
+            continue;
+        }
 
-        // Map board to display
-        parseInput(getKeyPress());
-        // Update board
-        updateBoard();
         // Draw the board
         drawBoard(field);
     }
 
-    // This should never reach
-    closeApp(9);
+    std::cout << "Stepped " << field.generation << " generations in " << stepMs << " ms on "
+              << pool.size() << " threads" << std::endl;
+
+    if (SETTINGS.headless) {
+        return 0;
+    }
+    closeApp(0);
 }
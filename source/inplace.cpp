@@ -0,0 +1,107 @@
+/***********************************************
+ * Project: RaspberryConway
+ * File: inplace.cpp
+ * By: ProgrammingIncluded
+ * Website: ProgrammingIncluded.github.io
+ * License: GNU GPLv3 (see LICENSE file)
+***********************************************/
+
+#include "inplace.hpp"
+#include "kernel.hpp"
+
+#include <cstring>
+
+// Rows held by the rolling buffer, the three the kernel reads and the
+// one it writes
+static const uint SLOTS = 4;
+
+StripeEdges::StripeEdges(const BitBoard &board, const TileGrid &stripes) {
+    this->pitch = board.pitch;
+    this->planes = board.planes;
+    this->rows.resize((size_t) stripes.size() * 2 * board.planes * board.pitch);
+}
+
+void StripeEdges::save(const BitBoard &board, const TileGrid &stripes) {
+    for (uint s = 0; s < stripes.size(); ++s) {
+        const Tile &stripe = stripes.tiles[s];
+        for (uint p = 0; p < this->planes; ++p) {
+            memcpy((uint64_t *) this->first(s, p) - 1, board.row(stripe.startY, p) - 1, sizeof(uint64_t) * this->pitch);
+            memcpy((uint64_t *) this->last(s, p) - 1, board.row(stripe.endY - 1, p) - 1, sizeof(uint64_t) * this->pitch);
+        }
+    }
+}
+
+bool stepStripeInPlace(BitBoard &board, const Tile &stripe, uint index, const StripeEdges &edges) {
+    uint pitch = board.pitch;
+    uint planes = board.planes;
+    // Kernels take one distance between planes for every row, so every
+    // slot keeps its planes SLOTS rows apart
+    long planeWords = (long) SLOTS * pitch;
+
+    thread_local static std::vector<uint64_t> buffer;
+    buffer.resize((size_t) SLOTS * planes * pitch);
+
+    // Row of a slot, word 0 like BitBoard::row
+    auto slot = [pitch](uint s) {
+        return buffer.data() + (size_t) s * pitch + 1;
+    };
+
+    // Copy a row with its ghost words into a slot, plane by plane
+    auto load = [planes, pitch, planeWords](uint64_t *to, const uint64_t *plane0, long fromPlaneWords) {
+        for (uint p = 0; p < planes; ++p) {
+            memcpy(to + p * planeWords - 1, plane0 + p * fromPlaneWords - 1, sizeof(uint64_t) * pitch);
+        }
+    };
+
+    uint64_t *up = slot(0);
+    uint64_t *mid = slot(1);
+    uint64_t *down = slot(2);
+    uint64_t *out = slot(3);
+
+    // Row above the stripe is the ghost row or the original last row of
+    // the stripe above
+    if (stripe.startY == 0) {
+        load(up, board.row(-1), board.planeWords);
+    } else {
+        load(up, edges.last(index - 1, 0), edges.planeWords());
+    }
+    load(mid, board.row(stripe.startY), board.planeWords);
+
+    const LifeKernel &kernel = lifeKernel();
+    uint last = board.stride - 1;
+    uint64_t diff = 0;
+
+    for (uint y = stripe.startY; y < stripe.endY; ++y) {
+        // Rows below are still the originals until the end of the stripe
+        if (y + 1 < stripe.endY || y + 1 == board.height) {
+            load(down, board.row(y + 1), board.planeWords);
+        } else {
+            load(down, edges.first(index + 1, 0), edges.planeWords());
+        }
+
+        kernel.step(up, mid, down, out, board.stride, planeWords);
+
+        for (uint p = 0; p < planes; ++p) {
+            uint64_t *cells = out + p * planeWords;
+            const uint64_t *old = mid + p * planeWords;
+
+            // Keep cells past the board edge dead
+            cells[last] &= board.lastMask;
+            diff |= (cells[last] ^ old[last]) & board.lastMask;
+            for (uint i = 0; i < last; ++i) {
+                diff |= cells[i] ^ old[i];
+            }
+
+            // Only the cells, ghost words are refilled before the next step
+            memcpy(board.row(y, p), cells, sizeof(uint64_t) * board.stride);
+        }
+
+        // The original of this row moves up, the one above is reused
+        uint64_t *spare = up;
+        up = mid;
+        mid = down;
+        down = spare;
+    }
+
+    return diff != 0;
+}
@@ -0,0 +1,58 @@
+/***********************************************
+ * Project: RaspberryConway
+ * File: inplace.hpp
+ * By: ProgrammingIncluded
+ * Website: ProgrammingIncluded.github.io
+ * License: GNU GPLv3 (see LICENSE file)
+***********************************************/
+#ifndef INPLACE_HPP
+#define INPLACE_HPP
+
+#include "bitboard.hpp"
+#include "tiling.hpp"
+
+#include <vector>
+
+// Stepping a board in place, so only one board is allocated. The board
+// is split into stripes of whole rows (a TileGrid one tile wide). While a
+// stripe is stepped, the original rows around the one being written are
+// kept in a small per thread buffer. The stripes either side may already
+// have overwritten their rows next to it, so the original first and last
+// row of every stripe are saved before any stripe is stepped.
+
+// First and last row of every stripe, including ghost words and planes
+class StripeEdges {
+    public:
+        StripeEdges(const BitBoard &board, const TileGrid &stripes);
+
+        // Copy the rows from board, after fillHalo and before any stripe
+        // of the generation is stepped
+        void save(const BitBoard &board, const TileGrid &stripes);
+
+        // Plane of the saved first or last row of a stripe, word 0 of the
+        // row like BitBoard::row
+        inline const uint64_t *first(uint stripe, uint plane) const {
+            return this->rows.data() + (stripe * 2 * this->planes + plane) * this->pitch + 1;
+        }
+
+        inline const uint64_t *last(uint stripe, uint plane) const {
+            return this->first(stripe, plane) + this->planes * this->pitch;
+        }
+
+        // Words between the planes of a saved row
+        inline long planeWords() const {
+            return this->pitch;
+        }
+
+    private:
+        uint pitch;
+        uint planes;
+        std::vector<uint64_t> rows;
+};
+
+// Compute the next generation of a stripe into the same board. Stripes
+// can be stepped in parallel once edges are saved. Gives the same cells
+// as stepTile. Returns true if any cell of the stripe changed.
+bool stepStripeInPlace(BitBoard &board, const Tile &stripe, uint index, const StripeEdges &edges);
+
+#endif /* INPLACE_HPP */
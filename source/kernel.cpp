@@ -0,0 +1,109 @@
+/***********************************************
+ * Project: RaspberryConway
+ * File: kernel.cpp
+ * By: ProgrammingIncluded
+ * Website: ProgrammingIncluded.github.io
+ * License: GNU GPLv3 (see LICENSE file)
+***********************************************/
+
+#include "kernel.hpp"
+#include "kernel_impl.hpp"
+
+#include <iostream>
+#include <vector>
+
+#if defined(__arm__) || defined(__aarch64__)
+#include <sys/auxv.h>
+#include <asm/hwcap.h>
+#endif
+
+namespace {
+
+RowKernel ruleKernelsScalar(const Rule &rule) {
+    return ruleKernels<Scalar>(rule);
+}
+
+}
+
+const RuleKernels LIFE_ROW_SCALAR = ruleKernelsScalar;
+
+bool verifyKernel(RowKernel kernel, const Rule &rule) {
+    // Cheap xorshift, random rows are enough to hit every code path
+    uint64_t seed = 0x9E3779B97F4A7C15ULL;
+    RowKernel scalar = LIFE_ROW_SCALAR(rule);
+    uint planes = statePlanes(rule.states);
+    // Mix of sizes so vector loops leave every possible scalar tail
+    const uint sizes[] = {1, 2, 3, 5, 8, 13, 33, 67};
+
+    for (uint size : sizes) {
+        // Each row gets a ghost word either side, planes follow each other
+        uint padded = size + 2;
+        long planeWords = padded * 3;
+        std::vector<uint64_t> rows(planeWords * planes);
+        std::vector<uint64_t> expect(planeWords * planes), got(planeWords * planes);
+        for (uint trial = 0; trial < 16; ++trial) {
+            for (uint64_t &w : rows) {
+                seed ^= seed << 13;
+                seed ^= seed >> 7;
+                seed ^= seed << 17;
+                w = seed;
+            }
+
+            const uint64_t *up = rows.data() + 1;
+            const uint64_t *mid = up + padded;
+            const uint64_t *down = mid + padded;
+            scalar(up, mid, down, expect.data(), size, planeWords, rule);
+            kernel(up, mid, down, got.data(), size, planeWords, rule);
+            if (expect != got) {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+static LifeKernel selectKernel(const Rule &rule) {
+    // Widest first
+    std::vector<LifeKernel> candidates;
+
+    #if defined(__x86_64__) || defined(__i386__)
+        __builtin_cpu_init();
+        if (LIFE_ROW_AVX2 != nullptr && __builtin_cpu_supports("avx2")) {
+            candidates.push_back({"AVX2", LIFE_ROW_AVX2(rule), rule});
+        }
+        if (LIFE_ROW_SSE2 != nullptr && __builtin_cpu_supports("sse2")) {
+            candidates.push_back({"SSE2", LIFE_ROW_SSE2(rule), rule});
+        }
+    #elif defined(__aarch64__)
+        if (LIFE_ROW_NEON != nullptr && (getauxval(AT_HWCAP) & HWCAP_ASIMD)) {
+            candidates.push_back({"NEON", LIFE_ROW_NEON(rule), rule});
+        }
+    #elif defined(__arm__)
+        if (LIFE_ROW_NEON != nullptr && (getauxval(AT_HWCAP) & HWCAP_NEON)) {
+            candidates.push_back({"NEON", LIFE_ROW_NEON(rule), rule});
+        }
+    #endif
+
+    for (LifeKernel &kernel : candidates) {
+        if (verifyKernel(kernel.row, rule)) {
+            return kernel;
+        }
+        std::cout << "Kernel " << kernel.name << " does not match scalar, skipping" << std::endl;
+    }
+
+    return {"Scalar", LIFE_ROW_SCALAR(rule), rule};
+}
+
+static LifeKernel KERNEL = {nullptr, nullptr, CONWAY};
+
+void setLifeRule(const Rule &rule) {
+    KERNEL = selectKernel(rule);
+}
+
+const LifeKernel &lifeKernel() {
+    if (KERNEL.row == nullptr) {
+        setLifeRule(CONWAY);
+    }
+    return KERNEL;
+}
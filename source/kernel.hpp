@@ -0,0 +1,64 @@
+/***********************************************
+ * Project: RaspberryConway
+ * File: kernel.hpp
+ * By: ProgrammingIncluded
+ * Website: ProgrammingIncluded.github.io
+ * License: GNU GPLv3 (see LICENSE file)
+***********************************************/
+#ifndef KERNEL_HPP
+#define KERNEL_HPP
+
+#include <cstdint>
+
+#include "rule.hpp"
+
+typedef unsigned int uint;
+
+// Computes the next generation of one packed row from the rows around it.
+// Every row must have a ghost word before and after it (see BitBoard)
+// which supplies the cells past either end. out must not alias inputs.
+// Kernels built for one rule ignore the rule argument.
+//
+// Rules with more than two states have statePlanes(states) planes, plane
+// p of any row is planeWords words after plane 0 (see BitBoard).
+typedef void (*RowKernel)(
+    const uint64_t *up, const uint64_t *mid, const uint64_t *down,
+    uint64_t *out, uint words, long planeWords, const Rule &rule
+);
+
+// Kernel of one instruction set for a rule. Common rules have their own
+// kernel with the rule built in, the rest share a generic one.
+typedef RowKernel (*RuleKernels)(const Rule &rule);
+
+struct LifeKernel {
+    const char *name;
+    RowKernel row;
+    Rule rule;
+
+    inline void step(
+        const uint64_t *up, const uint64_t *mid, const uint64_t *down,
+        uint64_t *out, uint words, long planeWords = 0
+    ) const {
+        this->row(up, mid, down, out, words, planeWords, this->rule);
+    }
+};
+
+// Kernels for each instruction set, nullptr if not built for this CPU.
+// Each lives in its own kernel_*.cpp compiled with matching flags.
+extern const RuleKernels LIFE_ROW_SCALAR;
+extern const RuleKernels LIFE_ROW_SSE2;
+extern const RuleKernels LIFE_ROW_AVX2;
+extern const RuleKernels LIFE_ROW_NEON;
+
+// Pick the kernel for a rule from the widest instruction set the running
+// CPU supports, checked bit for bit against the scalar kernel. Call
+// before any thread steps a board, the default is Conway.
+void setLifeRule(const Rule &rule);
+
+// Kernel picked by setLifeRule
+const LifeKernel &lifeKernel();
+
+// Compare a kernel with the scalar kernel over random rows
+bool verifyKernel(RowKernel kernel, const Rule &rule);
+
+#endif /* KERNEL_HPP */
@@ -0,0 +1,40 @@
+/***********************************************
+ * Project: RaspberryConway
+ * File: kernel_avx2.cpp
+ * By: ProgrammingIncluded
+ * Website: ProgrammingIncluded.github.io
+ * License: GNU GPLv3 (see LICENSE file)
+***********************************************/
+
+#include "kernel.hpp"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#include "kernel_impl.hpp"
+
+namespace {
+
+struct AVX2 {
+    // Unsigned lanes so right shifts are logical
+    typedef uint64_t W __attribute__((vector_size(32)));
+    static const uint LANES = 4;
+
+    static inline W load(const uint64_t *p) {
+        return (W) _mm256_loadu_si256((const __m256i *) p);
+    }
+
+    static inline void store(uint64_t *p, W w) {
+        _mm256_storeu_si256((__m256i *) p, (__m256i) w);
+    }
+};
+
+RowKernel ruleKernelsAVX2(const Rule &rule) {
+    return ruleKernels<AVX2>(rule);
+}
+
+}
+
+const RuleKernels LIFE_ROW_AVX2 = ruleKernelsAVX2;
+#else
+const RuleKernels LIFE_ROW_AVX2 = nullptr;
+#endif
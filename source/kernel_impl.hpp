@@ -0,0 +1,216 @@
+/***********************************************
+ * Project: RaspberryConway
+ * File: kernel_impl.hpp
+ * By: ProgrammingIncluded
+ * Website: ProgrammingIncluded.github.io
+ * License: GNU GPLv3 (see LICENSE file)
+***********************************************/
+#ifndef KERNEL_IMPL_HPP
+#define KERNEL_IMPL_HPP
+
+// Row kernel shared by every instruction set. Each kernel_*.cpp includes
+// this after picking its vector type so it is compiled with that file's
+// target flags. Everything here has internal linkage for the same reason.
+
+#include "kernel.hpp"
+#include "game.hpp"
+
+namespace {
+
+struct Scalar {
+    typedef uint64_t W;
+    static const uint LANES = 1;
+
+    static inline W load(const uint64_t *p) {
+        return *p;
+    }
+
+    static inline void store(uint64_t *p, W w) {
+        *p = w;
+    }
+};
+
+// Rule known at compile time
+template <uint BIRTH, uint SURVIVE>
+struct FixedRule {
+    template <class W>
+    static inline W word(
+        W nw, W nn, W ne, W ww, W cc, W ee, W sw, W ss, W se, const Rule &
+    ) {
+        return lifeWordRule<BIRTH, SURVIVE>(nw, nn, ne, ww, cc, ee, sw, ss, se);
+    }
+};
+
+// Any other rule, counts are tested against the masks at run time
+struct AnyRule {
+    template <class W>
+    static inline W word(
+        W nw, W nn, W ne, W ww, W cc, W ee, W sw, W ss, W se, const Rule &rule
+    ) {
+        return lifeWordGeneric(nw, nn, ne, ww, cc, ee, sw, ss, se, rule.birth, rule.survive);
+    }
+};
+
+// LANES words starting at word i. Neighbouring cells come from unaligned
+// loads one word either side, which for the edge words are ghost words.
+template <class V, class R>
+inline void lifeAt(
+    const uint64_t *up, const uint64_t *mid, const uint64_t *down,
+    uint64_t *out, uint i, long, const Rule &rule
+) {
+    typedef typename V::W W;
+
+    W u = V::load(up + i), m = V::load(mid + i), d = V::load(down + i);
+    W uw = V::load(up + i - 1), mw = V::load(mid + i - 1), dw = V::load(down + i - 1);
+    W ue = V::load(up + i + 1), me = V::load(mid + i + 1), de = V::load(down + i + 1);
+
+    V::store(out + i, R::word(
+        westOf(u, uw), u, eastOf(u, ue),
+        westOf(m, mw), m, eastOf(m, me),
+        westOf(d, dw), d, eastOf(d, de),
+        rule
+    ));
+}
+
+// Cells in state 1 of LANES words starting at word i of a row
+template <class V, uint PLANES>
+inline typename V::W aliveAt(const uint64_t *row, uint i, long planeWords) {
+    typename V::W alive = V::load(row + i);
+    for (uint p = 1; p < PLANES; ++p) {
+        alive &= ~V::load(row + p * planeWords + i);
+    }
+    return alive;
+}
+
+// Generations rules with PLANES bits of state per cell. Neighbours are
+// the cells in state 1 and go through the rule as for two states.
+template <class V, class R, uint PLANES>
+inline void statesAt(
+    const uint64_t *up, const uint64_t *mid, const uint64_t *down,
+    uint64_t *out, uint i, long planeWords, const Rule &rule
+) {
+    typedef typename V::W W;
+
+    W u = aliveAt<V, PLANES>(up, i, planeWords);
+    W m = aliveAt<V, PLANES>(mid, i, planeWords);
+    W d = aliveAt<V, PLANES>(down, i, planeWords);
+    W uw = aliveAt<V, PLANES>(up - 1, i, planeWords);
+    W mw = aliveAt<V, PLANES>(mid - 1, i, planeWords);
+    W dw = aliveAt<V, PLANES>(down - 1, i, planeWords);
+    W ue = aliveAt<V, PLANES>(up + 1, i, planeWords);
+    W me = aliveAt<V, PLANES>(mid + 1, i, planeWords);
+    W de = aliveAt<V, PLANES>(down + 1, i, planeWords);
+
+    // Born or survived, taken only by cells that are dead or alive
+    W next = R::word(
+        westOf(u, uw), u, eastOf(u, ue),
+        westOf(m, mw), m, eastOf(m, me),
+        westOf(d, dw), d, eastOf(d, de),
+        rule
+    );
+
+    // Count every other cell up by one with a ripple carry
+    W state[PLANES], up1[PLANES];
+    W carry = ~(m & ~m);
+    W dead = carry;
+    for (uint p = 0; p < PLANES; ++p) {
+        state[p] = V::load(mid + p * planeWords + i);
+        up1[p] = state[p] ^ carry;
+        carry &= state[p];
+        dead &= ~state[p];
+    }
+
+    // Dying cells cannot be born into
+    W one = next & (m | dead);
+
+    // Counting past the last state wraps to dead
+    W wrap = ~(m & ~m);
+    for (uint p = 0; p < PLANES; ++p) {
+        wrap &= (rule.states >> p & 1) ? up1[p] : ~up1[p];
+    }
+    W counted = ~dead & ~one & ~wrap;
+
+    for (uint p = 0; p < PLANES; ++p) {
+        W bit = up1[p] & counted;
+        V::store(out + p * planeWords + i, (p == 0) ? (bit | one) : bit);
+    }
+}
+
+// Two states, one plane
+template <class R>
+struct TwoStates {
+    template <class V>
+    static inline void at(
+        const uint64_t *up, const uint64_t *mid, const uint64_t *down,
+        uint64_t *out, uint i, long planeWords, const Rule &rule
+    ) {
+        lifeAt<V, R>(up, mid, down, out, i, planeWords, rule);
+    }
+};
+
+template <class R, uint PLANES>
+struct ManyStates {
+    template <class V>
+    static inline void at(
+        const uint64_t *up, const uint64_t *mid, const uint64_t *down,
+        uint64_t *out, uint i, long planeWords, const Rule &rule
+    ) {
+        statesAt<V, R, PLANES>(up, mid, down, out, i, planeWords, rule);
+    }
+};
+
+// V provides the vector type W, LANES words per vector, load and store.
+// C is TwoStates or ManyStates with the rule. The row is done LANES words
+// at a time with a scalar tail, no edge cases.
+template <class V, class C>
+void lifeRow(
+    const uint64_t *up, const uint64_t *mid, const uint64_t *down,
+    uint64_t *out, uint words, long planeWords, const Rule &rule
+) {
+    uint i = 0;
+    for (; i + V::LANES <= words; i += V::LANES) {
+        C::template at<V>(up, mid, down, out, i, planeWords, rule);
+    }
+
+    for (; i < words; ++i) {
+        C::template at<Scalar>(up, mid, down, out, i, planeWords, rule);
+    }
+}
+
+// Rules with a kernel of their own, add common rules here
+template <class V>
+RowKernel ruleKernels(const Rule &rule) {
+    if (rule == CONWAY) {
+        return lifeRow<V, TwoStates<FixedRule<CONWAY.birth, CONWAY.survive>>>;
+    }
+    if (rule == HIGHLIFE) {
+        return lifeRow<V, TwoStates<FixedRule<HIGHLIFE.birth, HIGHLIFE.survive>>>;
+    }
+    if (rule == DAY_AND_NIGHT) {
+        return lifeRow<V, TwoStates<FixedRule<DAY_AND_NIGHT.birth, DAY_AND_NIGHT.survive>>>;
+    }
+    if (rule == SEEDS) {
+        return lifeRow<V, TwoStates<FixedRule<SEEDS.birth, SEEDS.survive>>>;
+    }
+    if (rule == BRIANS_BRAIN) {
+        return lifeRow<V, ManyStates<FixedRule<BRIANS_BRAIN.birth, BRIANS_BRAIN.survive>, 2>>;
+    }
+    if (rule == STAR_WARS) {
+        return lifeRow<V, ManyStates<FixedRule<STAR_WARS.birth, STAR_WARS.survive>, 2>>;
+    }
+
+    switch (statePlanes(rule.states)) {
+        case 1:
+            return lifeRow<V, TwoStates<AnyRule>>;
+        case 2:
+            return lifeRow<V, ManyStates<AnyRule, 2>>;
+        case 3:
+            return lifeRow<V, ManyStates<AnyRule, 3>>;
+        default:
+            return lifeRow<V, ManyStates<AnyRule, 4>>;
+    }
+}
+
+}
+
+#endif /* KERNEL_IMPL_HPP */
@@ -0,0 +1,40 @@
+/***********************************************
+ * Project: RaspberryConway
+ * File: kernel_neon.cpp
+ * By: ProgrammingIncluded
+ * Website: ProgrammingIncluded.github.io
+ * License: GNU GPLv3 (see LICENSE file)
+***********************************************/
+
+#include "kernel.hpp"
+
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#include "kernel_impl.hpp"
+
+namespace {
+
+struct NEON {
+    // uint64x2_t supports the bitwise and shift operators directly
+    typedef uint64x2_t W;
+    static const uint LANES = 2;
+
+    static inline W load(const uint64_t *p) {
+        return vld1q_u64(p);
+    }
+
+    static inline void store(uint64_t *p, W w) {
+        vst1q_u64(p, w);
+    }
+};
+
+RowKernel ruleKernelsNEON(const Rule &rule) {
+    return ruleKernels<NEON>(rule);
+}
+
+}
+
+const RuleKernels LIFE_ROW_NEON = ruleKernelsNEON;
+#else
+const RuleKernels LIFE_ROW_NEON = nullptr;
+#endif
@@ -0,0 +1,40 @@
+/***********************************************
+ * Project: RaspberryConway
+ * File: kernel_sse2.cpp
+ * By: ProgrammingIncluded
+ * Website: ProgrammingIncluded.github.io
+ * License: GNU GPLv3 (see LICENSE file)
+***********************************************/
+
+#include "kernel.hpp"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#include "kernel_impl.hpp"
+
+namespace {
+
+struct SSE2 {
+    // Unsigned lanes so right shifts are logical
+    typedef uint64_t W __attribute__((vector_size(16)));
+    static const uint LANES = 2;
+
+    static inline W load(const uint64_t *p) {
+        return (W) _mm_loadu_si128((const __m128i *) p);
+    }
+
+    static inline void store(uint64_t *p, W w) {
+        _mm_storeu_si128((__m128i *) p, (__m128i) w);
+    }
+};
+
+RowKernel ruleKernelsSSE2(const Rule &rule) {
+    return ruleKernels<SSE2>(rule);
+}
+
+}
+
+const RuleKernels LIFE_ROW_SSE2 = ruleKernelsSSE2;
+#else
+const RuleKernels LIFE_ROW_SSE2 = nullptr;
+#endif
@@ -0,0 +1,287 @@
+/***********************************************
+ * Project: RaspberryConway
+ * File: ltl.cpp
+ * By: ProgrammingIncluded
+ * Website: ProgrammingIncluded.github.io
+ * License: GNU GPLv3 (see LICENSE file)
+***********************************************/
+
+#include "ltl.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <vector>
+
+// Reads a number at pos and moves pos past it, false if there is none
+static bool parseNumber(const std::string &text, size_t &pos, uint &value) {
+    size_t start = pos;
+    value = 0;
+    while (pos < text.size() && std::isdigit(text[pos])) {
+        value = value * 10 + (text[pos] - '0');
+        pos += 1;
+    }
+    return pos != start && pos - start <= 4;
+}
+
+// Range as min..max or a single count
+static bool parseRange(const std::string &text, uint &min, uint &max) {
+    size_t pos = 0;
+    if (!parseNumber(text, pos, min)) {
+        return false;
+    }
+
+    max = min;
+    if (pos == text.size()) {
+        return true;
+    }
+    if (text.compare(pos, 2, "..") != 0) {
+        return false;
+    }
+    pos += 2;
+    return parseNumber(text, pos, max) && pos == text.size() && min <= max;
+}
+
+bool parseLtlRule(const std::string &text, LtlRule &rule) {
+    LtlRule parsed = {0, MOORE, true, 1, 0, 1, 0};
+    bool birth = false;
+    bool survive = false;
+
+    size_t start = 0;
+    while (start <= text.size()) {
+        size_t end = std::min(text.find(',', start), text.size());
+        std::string part = text.substr(start, end - start);
+        start = end + 1;
+        if (part.empty()) {
+            return false;
+        }
+
+        char key = std::toupper(part[0]);
+        std::string value = part.substr(1);
+        size_t pos = 0;
+        uint number = 0;
+
+        if (key == 'R') {
+            if (!parseNumber(value, pos, number) || pos != value.size()) {
+                return false;
+            }
+            parsed.radius = number;
+        } else if (key == 'C') {
+            // 0 and 2 both mean two states
+            if (!parseNumber(value, pos, number) || pos != value.size() || number > 2 || number == 1) {
+                return false;
+            }
+        } else if (key == 'M') {
+            if (value != "0" && value != "1") {
+                return false;
+            }
+            parsed.middle = (value == "1");
+        } else if (key == 'S') {
+            survive = parseRange(value, parsed.surviveMin, parsed.surviveMax);
+            if (!survive) {
+                return false;
+            }
+        } else if (key == 'B') {
+            birth = parseRange(value, parsed.birthMin, parsed.birthMax);
+            if (!birth) {
+                return false;
+            }
+        } else if (key == 'N') {
+            if (value == "M" || value == "m") {
+                parsed.neighbourhood = MOORE;
+            } else if (value == "N" || value == "n") {
+                parsed.neighbourhood = VON_NEUMANN;
+            } else {
+                return false;
+            }
+        } else {
+            return false;
+        }
+    }
+
+    if (parsed.radius == 0 || parsed.radius > MAX_LTL_RADIUS || !birth || !survive) {
+        return false;
+    }
+    if (parsed.birthMin == 0) {
+        return false;
+    }
+
+    rule = parsed;
+    return true;
+}
+
+std::string ltlRuleString(const LtlRule &rule) {
+    return "R" + std::to_string(rule.radius) +
+        ",C0,M" + (rule.middle ? "1" : "0") +
+        ",S" + std::to_string(rule.surviveMin) + ".." + std::to_string(rule.surviveMax) +
+        ",B" + std::to_string(rule.birthMin) + ".." + std::to_string(rule.birthMax) +
+        ",N" + (rule.neighbourhood == MOORE ? "M" : "N");
+}
+
+bool stepTileLtl(
+    const BitBoard &src, BitBoard &dst,
+    const Tile &tile, const LtlRule &rule, Boundary boundary
+) {
+    // Local area is the tile with a halo one wider than the radius, so
+    // the prefix sums below never need to look outside it
+    int radius = rule.radius;
+    int halo = radius + 1;
+    long firstX = (long) tile.startWord * 64 - halo;
+    long firstY = (long) tile.startY - halo;
+    uint tileX = tile.startWord * 64;
+    uint tileWidth = std::min(tile.endWord * 64, src.width) - tileX;
+    uint tileHeight = tile.endY - tile.startY;
+    int width = tileWidth + 2 * halo;
+    int height = tileHeight + 2 * halo;
+
+    // Scratch is kept per thread between calls
+    static thread_local std::vector<uint8_t> cells;
+    static thread_local std::vector<long> boardX;
+    static thread_local std::vector<int> sums;
+    static thread_local std::vector<uint16_t> downRight;
+    static thread_local std::vector<uint16_t> upRight;
+    cells.resize(width * height);
+    boardX.resize(width);
+
+    auto cell = [width](int x, int y) -> int {
+        return cells[x + y * width];
+    };
+
+    // Board column of each local column, -1 past a dead edge
+    for (int x = 0; x < width; ++x) {
+        long bx = firstX + x;
+        if (boundary == TORUS) {
+            bx = ((bx % src.width) + src.width) % src.width;
+        } else if (bx < 0 || bx >= src.width) {
+            bx = -1;
+        }
+        boardX[x] = bx;
+    }
+
+    // Gather the tile and its halo
+    for (int y = 0; y < height; ++y) {
+        long by = firstY + y;
+        if (boundary == TORUS) {
+            by = ((by % src.height) + src.height) % src.height;
+        }
+
+        uint8_t *row = cells.data() + y * width;
+        if (by < 0 || by >= src.height) {
+            std::fill(row, row + width, 0);
+            continue;
+        }
+        for (int x = 0; x < width; ++x) {
+            row[x] = (boardX[x] < 0) ? 0 : src.get(boardX[x], by);
+        }
+    }
+
+    // Count of each tile cell of the current row, in local columns
+    sums.assign(width, 0);
+
+    if (rule.neighbourhood == VON_NEUMANN) {
+        // Sums along each diagonal up to and including a cell, from the
+        // top left and from the top right
+        downRight.resize(width * height);
+        upRight.resize(width * height);
+        for (int y = 0; y < height; ++y) {
+            for (int x = 0; x < width; ++x) {
+                int i = x + y * width;
+                downRight[i] = cell(x, y) + ((x > 0 && y > 0) ? downRight[i - width - 1] : 0);
+                upRight[i] = cell(x, y) + ((x + 1 < width && y > 0) ? upRight[i - width + 1] : 0);
+            }
+        }
+    }
+
+    // Cells (x, y) to (x + k, y + k)
+    auto diagonal = [width](int x, int y, int k) -> int {
+        return downRight[(x + k) + (y + k) * width] - downRight[(x - 1) + (y - 1) * width];
+    };
+    // Cells (x, y) to (x + k, y - k)
+    auto antiDiagonal = [width](int x, int y, int k) -> int {
+        return upRight[x + y * width] - upRight[(x + k + 1) + (y - k - 1) * width];
+    };
+
+    uint64_t diff = 0;
+    for (int y = halo; y < halo + (int) tileHeight; ++y) {
+        if (rule.neighbourhood == MOORE) {
+            // Running sum down each column, the first row sums the window
+            if (y == halo) {
+                for (int dy = -radius; dy <= radius; ++dy) {
+                    const uint8_t *add = &cells[(y + dy) * width];
+                    for (int x = 0; x < width; ++x) {
+                        sums[x] += add[x];
+                    }
+                }
+            } else {
+                const uint8_t *add = &cells[(y + radius) * width];
+                const uint8_t *sub = &cells[(y - radius - 1) * width];
+                for (int x = 0; x < width; ++x) {
+                    sums[x] += add[x] - sub[x];
+                }
+            }
+        } else if (y == halo) {
+            // First cell of the first row is counted directly, the rest
+            // of the row slides right, swapping one edge of the diamond
+            // for the other
+            int x = halo;
+            for (int dy = -radius; dy <= radius; ++dy) {
+                int span = radius - std::abs(dy);
+                for (int dx = -span; dx <= span; ++dx) {
+                    sums[x] += cell(x + dx, y + dy);
+                }
+            }
+
+            for (x = halo + 1; x < halo + (int) tileWidth; ++x) {
+                sums[x] = sums[x - 1] +
+                    diagonal(x, y - radius, radius) + antiDiagonal(x, y + radius, radius - 1) -
+                    antiDiagonal(x - 1 - radius, y, radius) - diagonal(x - radius, y + 1, radius - 1);
+            }
+        } else {
+            // Each diamond slides down from the one above
+            for (int x = halo; x < halo + (int) tileWidth; ++x) {
+                sums[x] +=
+                    diagonal(x - radius, y, radius) + antiDiagonal(x + 1, y + radius - 1, radius - 1) -
+                    antiDiagonal(x - radius, y - 1, radius) - diagonal(x + 1, y - radius, radius - 1);
+            }
+        }
+
+        // Moore counts across the column sums, sliding along the row
+        int window = 0;
+        if (rule.neighbourhood == MOORE) {
+            for (int dx = -radius; dx <= radius; ++dx) {
+                window += sums[halo + dx];
+            }
+        }
+
+        const uint64_t *old = src.row(tile.startY + y - halo) + tile.startWord;
+        uint64_t *out = dst.row(tile.startY + y - halo) + tile.startWord;
+        uint64_t word = 0;
+        for (uint i = 0; i < tileWidth; ++i) {
+            int x = halo + i;
+            int count = sums[x];
+            if (rule.neighbourhood == MOORE) {
+                if (i > 0) {
+                    window += sums[x + radius] - sums[x - radius - 1];
+                }
+                count = window;
+            }
+
+            bool alive = cell(x, y);
+            count -= (alive && !rule.middle) ? 1 : 0;
+            bool next = alive ?
+                (count >= (int) rule.surviveMin && count <= (int) rule.surviveMax) :
+                (count >= (int) rule.birthMin && count <= (int) rule.birthMax);
+            word |= (uint64_t) next << (i & 63);
+
+            // Cells past the board edge are left dead, the torus ghost
+            // cell in the padding of src is not a change
+            if ((i & 63) == 63 || i + 1 == tileWidth) {
+                uint64_t mask = (tileX + i + 1 == src.width) ? src.lastMask : ~(uint64_t) 0;
+                diff |= word ^ (old[i >> 6] & mask);
+                out[i >> 6] = word;
+                word = 0;
+            }
+        }
+    }
+
+    return diff != 0;
+}
@@ -0,0 +1,61 @@
+/***********************************************
+ * Project: RaspberryConway
+ * File: ltl.hpp
+ * By: ProgrammingIncluded
+ * Website: ProgrammingIncluded.github.io
+ * License: GNU GPLv3 (see LICENSE file)
+***********************************************/
+#ifndef LTL_HPP
+#define LTL_HPP
+
+#include "bitboard.hpp"
+#include "tiling.hpp"
+
+#include <string>
+
+// Largest neighbourhood radius for Larger than Life rules
+static const uint MAX_LTL_RADIUS = 10;
+
+enum Neighbourhood {
+    // Square of side 2 * radius + 1
+    MOORE,
+    // Diamond of cells within radius steps along the axes
+    VON_NEUMANN
+};
+
+// Larger than Life rule, two states with neighbours counted over a range
+// instead of the 8 cells around. A dead cell is born if its count is in
+// [birthMin, birthMax] and a live cell survives if it is in
+// [surviveMin, surviveMax]. radius 0 means no rule is set.
+struct LtlRule {
+    uint radius;
+    Neighbourhood neighbourhood;
+    // Count the cell itself along with its neighbours
+    bool middle;
+    uint birthMin;
+    uint birthMax;
+    uint surviveMin;
+    uint surviveMax;
+};
+
+// Parse the Golly notation, e.g. R5,C0,M1,S34..58,B34..45,NM for Bosco's
+// rule. Only two states and the Moore (NM) and von Neumann (NN)
+// neighbourhoods are supported, and birth on 0 is refused as for B/S
+// rules. Returns false and leaves rule alone if the string is not valid.
+bool parseLtlRule(const std::string &text, LtlRule &rule);
+
+// Rule in Golly notation
+std::string ltlRuleString(const LtlRule &rule);
+
+// Advance a tile of src by one generation into dst. The tile plus a halo
+// of radius cells is unpacked into a per thread buffer and counted with
+// sliding sums, so the cost per cell does not grow with the radius: a
+// running sum down each column and across each row for Moore, diagonal
+// prefix sums for the edges of the diamond for von Neumann. Does not use
+// the ghost cells. Returns true if any cell of the tile changed.
+bool stepTileLtl(
+    const BitBoard &src, BitBoard &dst,
+    const Tile &tile, const LtlRule &rule, Boundary boundary
+);
+
+#endif /* LTL_HPP */
@@ -7,14 +7,29 @@
 ***********************************************/
 
 #include "app.hpp"
-#include "game.hpp"
+#include "bitboard.hpp"
+#include "chunked.hpp"
+#include "cluster.hpp"
+#include "fileboard.hpp"
+#include "inplace.hpp"
+#include "kernel.hpp"
+#include "ltl.hpp"
+#include "morton.hpp"
 #include "rle_loader.hpp"
-
+#include "settings.hpp"
+#include "sparse.hpp"
+#include "threadpool.hpp"
+#include "tiling.hpp"
+#include "temporal.hpp"
+#include "wavefront.hpp"
+
+#include <cstdio>
+#include <cstdlib>
 #include <iostream>
-#include <cstring>
 #include <chrono>
 #include <thread>
-#include <vector>
+#include <utility>
+#include <algorithm>
 
 #define DEBUG 0
 
@@ -22,9 +37,10 @@
 static uint BOARD_X = 2048;
 static uint BOARD_Y = 2048;
 
-// Where the render window should be relative to screen coordinates
-static uint POS_X = 0;
-static uint POS_Y = 0;
+// Where the render window should be relative to screen coordinates.
+// Signed since the chunked plane goes on past the top left.
+static lint POS_X = 0;
+static lint POS_Y = 0;
 
 // Set by main to allow scaling to be dynamic from screen size
 static uint BOARD_TIMES_X = 1;
@@ -33,87 +49,340 @@ static uint BOARD_TIMES_Y = 1;
 // Other Controls
 static bool PAUSE = false;
 
+// No display or keyboard, set by main from SETTINGS.headless
+static bool HEADLESS = false;
+
+// End the run, giving the screen back if there is one
+static void stopRun(int status) {
+    if (HEADLESS) {
+        exit(status);
+    }
+    closeApp(status);
+}
+
 // ms per frame
 static const double MSPF = 0.0;
 
-static bool *BOARD_BUFFER;
-static bool *VIRTUAL_BOARD;
+static BitBoard *BOARD_BUFFER;
+static BitBoard *VIRTUAL_BOARD;
+
+// Set instead of the boards above by the out of core engine, drawn into
+// VIEW. Generations alternate between the two files.
+static FileBoard *FILE_BOARD;
+static FileBoard *FILE_BUFFER;
+
+// Set when the board is stepped in place, BOARD_BUFFER is not allocated
+static StripeEdges *STRIPE_EDGES;
+
+// Set instead of the boards above for the Morton layout, drawn into VIEW
+static MortonBoard *MORTON_BOARD;
+static MortonBoard *MORTON_BUFFER;
 
+// Blocks per task of the Morton board, a 256x256 cell square
+static const uint64_t MORTON_TASK_BLOCKS = 1024;
+
+// Set instead of the boards above when the sparse engine is picked. Only
+// the cells on screen are drawn into VIEW, which starts at POS_X, POS_Y.
+static SparseBoard *SPARSE_BOARD;
+static BitBoard *VIEW;
+
+// Set instead of the boards above by the chunked engine, drawn into VIEW
+// the same way. Has no edges so the view can move anywhere.
+static ChunkedBoard *CHUNKED_BOARD;
+
+// Set when the board is split across processes. VIRTUAL_BOARD and
+// BOARD_BUFFER then hold only this rank's STRIP_ROWS rows from board row
+// STRIP_FIRST, with RANGE rows of the ranks above and below either side.
+static Cluster *CLUSTER;
+static uint STRIP_FIRST = 0;
+static uint STRIP_ROWS = 0;
+
+// ms this rank spent stepping and waiting on the other ranks
+static double COMPUTE_MS = 0;
+static double WAIT_MS = 0;
+
+// Set by main from SETTINGS.threads
 static uint THREADS = 4;
 
+// Generations per pass over the board, set by main from SETTINGS.temporal
+static uint STEPS = 1;
+
+// Cells around a tile it depends on each pass, STEPS or the radius of a
+// Larger than Life rule
+static uint RANGE = 1;
+
+// Passes per frame, set by main from SETTINGS.generations
+static uint PASSES = 1;
+
+// Colour of each cell state, set by main from the rule
+static uint PALETTE[MAX_STATES];
+
+// Dead is black and alive white. Dying states fade from yellow to a dark
+// red on their way back to dead.
+void setupPalette(uint states) {
+    PALETTE[0] = 0;
+    PALETTE[1] = 0xFFFFFFFF;
+    for (uint s = 2; s < states; ++s) {
+        // 255 for the first dying state down to 64 for the last
+        uint red = 64 + 191 * (states - 1 - s) / (states - 2);
+        uint green = (red > 128) ? (red - 128) * 2 : 0;
+        PALETTE[s] = 0xFF000000 | (red << 16) | (green << 8);
+    }
+}
+
+// State of the cell x, y from the top left of the view for any engine
+inline uint cellState(uint x, uint y) {
+    if (VIEW != nullptr) {
+        return VIEW->state(x, y);
+    }
+    return VIRTUAL_BOARD->state(POS_X + x, POS_Y + y);
+}
+
+// Bring VIEW up to date after the board or the view moved
+void renderView() {
+    if (SPARSE_BOARD != nullptr) {
+        SPARSE_BOARD->render(*VIEW, POS_X, POS_Y);
+    }
+    if (CHUNKED_BOARD != nullptr) {
+        CHUNKED_BOARD->render(*VIEW, POS_X, POS_Y);
+    }
+    if (MORTON_BOARD != nullptr) {
+        MORTON_BOARD->render(*VIEW, POS_X, POS_Y);
+    }
+    if (FILE_BOARD != nullptr) {
+        FILE_BOARD->render(*VIEW, POS_X, POS_Y);
+    }
+}
+
 // TODO: Probably want graphics card to do this
 // Virtualboard size + padding should be a multiple of screen size 
 inline void drawBoard(uint offsetX, uint offsetY, uint screenX, uint screenY) {
     // Assume screen_x >= board_x, screen_y >= board_y
     // Display buffer
     // Iterate through the viewport which is screen size adjusted by scale and view shift
-    for (uint y = POS_Y + offsetY; y < POS_Y + (offsetY + screenY) / BOARD_TIMES_Y; y += 1) {
-        for(uint x = POS_X + offsetX; x < POS_X + (offsetX + screenX) / BOARD_TIMES_X; x += 1) {
+    for (uint y = offsetY; y < (offsetY + screenY) / BOARD_TIMES_Y; y += 1) {
+        for(uint x = offsetX; x < (offsetX + screenX) / BOARD_TIMES_X; x += 1) {
             // Get pixel from boardspace
-            bool cur = VIRTUAL_BOARD[x + (y * BOARD_X)];
+            uint cur = PALETTE[cellState(x, y)];
 
             // Convert board to screen space
-            uint trans_x = (x - POS_X) * BOARD_TIMES_X;
-            uint trans_y = (y - POS_Y) * BOARD_TIMES_Y;
+            uint trans_x = x * BOARD_TIMES_X;
+            uint trans_y = y * BOARD_TIMES_Y;
 
             // Draw entire pixel in screen space with enlarging in mind
             for (uint new_y = trans_y; new_y < trans_y + BOARD_TIMES_Y; ++new_y) {
                 for (uint new_x = trans_x; new_x < trans_x + BOARD_TIMES_X; ++new_x) {
-                    DISPLAY[new_x + (new_y * SCREEN_X)] = 0xFFFFFFFF * cur;
+                    DISPLAY[new_x + (new_y * SCREEN_X)] = cur;
                 }
             }
         }
     }
 }
 
-// Soft wrapper to deal with edge cases
-// Starts with 0 index
-bool getTile(uint x, uint y, bool *vb, uint board_x, uint board_y) {
-    if (x >= BOARD_X || y >= BOARD_Y || x < 0 || y < 0) {
-        return 0;
+// Runs STEPS iterations of the board game for a single tile
+// Threadable function, reads only from vb and writes only to bb
+// Returns true if the tile changed
+bool updateBoard(BitBoard *vb, BitBoard *bb, const Tile &tile) {
+    if (SETTINGS.ltl.radius > 0) {
+        return stepTileLtl(*vb, *bb, tile, SETTINGS.ltl, SETTINGS.boundary);
+    }
+    if (STEPS > 1) {
+        return stepTileTemporal(*vb, *bb, tile, STEPS, SETTINGS.boundary);
+    }
+    return stepTile(*vb, *bb, tile.startWord, tile.endWord, tile.startY, tile.endY);
+}
+
+// Advance the board PASSES times, waiting for every tile after each pass
+void stepBarrier(ThreadPool &pool, TileGrid &grid) {
+    for (uint pass = 0; pass < PASSES; ++pass) {
+        // Ghost cells are filled once up front so the kernels never
+        // have to look at the edges
+        VIRTUAL_BOARD->fillHalo(SETTINGS.boundary);
+
+        // Update board one tile at a time, skipping tiles with no
+        // changes around them last generation
+        grid.markActive(SETTINGS.boundary, RANGE);
+        pool.run(grid.active.size(), [&grid](uint i) {
+            uint t = grid.active[i];
+            grid.changed[t] = updateBoard(VIRTUAL_BOARD, BOARD_BUFFER, grid.tiles[t]);
+        });
+
+        if (SETTINGS.stats) {
+            std::cout << "Active tiles: " << grid.active.size() << "/" << grid.size() << std::endl;
+        }
+
+        // Every tile is done reading the old generation, so the
+        // buffer becomes the board without copying it back
+        std::swap(VIRTUAL_BOARD, BOARD_BUFFER);
+    }
+}
+
+// Advance the board PASSES times in place, grid is one tile wide
+void stepInPlace(ThreadPool &pool, TileGrid &grid) {
+    for (uint pass = 0; pass < PASSES; ++pass) {
+        VIRTUAL_BOARD->fillHalo(SETTINGS.boundary);
+        grid.markActive(SETTINGS.boundary);
+
+        // Stripes overwrite rows their neighbours read, so the originals
+        // are kept aside first
+        STRIPE_EDGES->save(*VIRTUAL_BOARD, grid);
+        pool.run(grid.active.size(), [&grid](uint i) {
+            uint s = grid.active[i];
+            grid.changed[s] = stepStripeInPlace(*VIRTUAL_BOARD, grid.tiles[s], s, *STRIPE_EDGES);
+        });
+
+        if (SETTINGS.stats) {
+            std::cout << "Active stripes: " << grid.active.size() << "/" << grid.size() << std::endl;
+        }
+    }
+}
+
+// Advance the board PASSES times with no barrier between passes, each
+// tile moving on once the tiles around it have caught up
+void stepWavefront(ThreadPool &pool, TileGrid &grid, Wavefront &wavefront) {
+    VIRTUAL_BOARD->fillHalo(SETTINGS.boundary);
+
+    wavefront.run(pool, PASSES, [&grid](uint t, uint pass) {
+        // Boards alternate every pass
+        BitBoard *src = (pass % 2 == 0) ? VIRTUAL_BOARD : BOARD_BUFFER;
+        BitBoard *dst = (pass % 2 == 0) ? BOARD_BUFFER : VIRTUAL_BOARD;
+        const Tile &tile = grid.tiles[t];
+        bool changed = updateBoard(src, dst, tile);
+
+        // No global pass to fill the ghost cells, so each tile fills
+        // the ones copied from its own cells
+        dst->fillHalo(SETTINGS.boundary, tile.startWord, tile.endWord, tile.startY, tile.endY);
+        return changed;
+    });
+
+    if (SETTINGS.stats) {
+        std::cout << "Active tiles: " << wavefront.stepped << "/" << grid.size() * PASSES << std::endl;
+    }
+
+    if (PASSES % 2 == 1) {
+        std::swap(VIRTUAL_BOARD, BOARD_BUFFER);
+    }
+}
+
+// Advance the Morton board PASSES times, each task a square of blocks
+void stepMortonBoard(ThreadPool &pool) {
+    uint64_t blocks = MORTON_BOARD->size();
+    uint tasks = (blocks + MORTON_TASK_BLOCKS - 1) / MORTON_TASK_BLOCKS;
+
+    for (uint pass = 0; pass < PASSES; ++pass) {
+        pool.run(tasks, [blocks](uint t) {
+            uint64_t first = t * MORTON_TASK_BLOCKS;
+            uint64_t last = std::min(first + MORTON_TASK_BLOCKS, blocks);
+            stepMorton(*MORTON_BOARD, *MORTON_BUFFER, first, last, SETTINGS.boundary);
+        });
+        std::swap(MORTON_BOARD, MORTON_BUFFER);
+    }
+}
+
+// Swap the names of the two board files, so --file is always the latest
+// generation and a later run carries on from it
+static void swapBoardFiles() {
+    std::string next = SETTINGS.file + ".next";
+    std::string swap = SETTINGS.file + ".swap";
+    if (std::rename(SETTINGS.file.c_str(), swap.c_str()) != 0 ||
+        std::rename(next.c_str(), SETTINGS.file.c_str()) != 0 ||
+        std::rename(swap.c_str(), next.c_str()) != 0) {
+        std::cout << "Unable to rename board files: " << SETTINGS.file << std::endl;
     }
+}
 
-    return vb[x + (y * BOARD_X)];
+// Advance the file board PASSES times, a block of tileHeight rows at a
+// time. Returns false if a read or write failed, the boards are no good
+// after that.
+bool stepOutOfCore(ThreadPool &pool) {
+    for (uint pass = 0; pass < PASSES; ++pass) {
+        if (!stepFileBoard(*FILE_BOARD, *FILE_BUFFER, SETTINGS.tileHeight, SETTINGS.boundary, pool)) {
+            return false;
+        }
+        std::swap(FILE_BOARD, FILE_BUFFER);
+        swapBoardFiles();
+    }
+    return true;
 }
 
-// Runs one iteration of the board game
-// Threadable function
-void updateBoard(bool *vb, bool *bb, uint t) {
-    // Naive implementation
-    uint board_y = BOARD_Y / THREADS;
-    uint board_x = BOARD_X;
-    uint offsetX = 0;
-    uint offsetY = board_y * t;
-    uint boundY = board_y + offsetY;
-
-    for (uint y=offsetY; y < boundY; y += 1) {
-        for(uint x=offsetX; x < board_x + offsetX; x += 1) {
-            // Current cell
-            bool cur = vb[x + (y * BOARD_X)];
-            // Get neighbors of tiles
-            bool n0 = getTile(x + 1, y, vb, board_x, boundY);
-            bool n1 = getTile(x + 1, y + 1, vb, board_x, boundY);
-            bool n2 = getTile(x + 1, y - 1, vb, board_x, boundY);
-            bool n3 = getTile(x - 1, y + 1, vb, board_x, boundY);
-            bool n4 = getTile(x - 1, y - 1, vb, board_x, boundY);
-            bool n5 = getTile(x - 1, y, vb, board_x, boundY);
-            bool n6 = getTile(x, y + 1, vb, board_x, boundY);
-            bool n7 = getTile(x, y - 1, vb, board_x, boundY);
-
-            // Check if alive
-            bb[x + (y * BOARD_X)] = 0xFFFFFFFF && life(
-                                                    n0, n1, n2,
-                                                    n3, cur, n4,
-                                                    n5, n6, n7
-                                                );
+// Advance this rank's strip PASSES times. The halo rows are exchanged
+// while the rows that do not need them are stepped. Returns false if a
+// neighbouring rank is gone.
+bool stepCluster(ThreadPool &pool) {
+    double waited = 0;
+    auto start = std::chrono::steady_clock::now();
+
+    for (uint pass = 0; pass < PASSES; ++pass) {
+        bool linked = stepStrip(
+            *CLUSTER, *VIRTUAL_BOARD, *BOARD_BUFFER, RANGE, SETTINGS.boundary, pool,
+            [](const Tile &tile) {
+                updateBoard(VIRTUAL_BOARD, BOARD_BUFFER, tile);
+            },
+            waited
+        );
+        if (!linked) {
+            return false;
         }
+        std::swap(VIRTUAL_BOARD, BOARD_BUFFER);
     }
-    // Update previous VIRTUAL_BOARD to new buffer
-    memcpy(vb + board_x * offsetY, bb + board_x * offsetY, sizeof(bool) * board_x * board_y);
 
-    if (BOARD_TIMES_X == 1 && BOARD_TIMES_Y == 1) {
-        drawBoard(0, SCREEN_Y / THREADS * t, SCREEN_X, SCREEN_Y / THREADS);
+    double total = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    COMPUTE_MS += total - waited;
+    WAIT_MS += waited;
+
+    if (SETTINGS.stats) {
+        std::cout << "Rank " << CLUSTER->rank << " compute: " << total - waited
+                  << " ms wait: " << waited << " ms" << std::endl;
     }
+    return true;
+}
+
+// Cells in state 1 in this rank's strip
+ulint stripPopulation() {
+    ulint count = 0;
+    for (uint y = RANGE; y < RANGE + STRIP_ROWS; ++y) {
+        for (uint w = 0; w < VIRTUAL_BOARD->stride; ++w) {
+            uint64_t alive = VIRTUAL_BOARD->row(y, 0)[w];
+            for (uint p = 1; p < VIRTUAL_BOARD->planes; ++p) {
+                alive &= ~VIRTUAL_BOARD->row(y, p)[w];
+            }
+            count += __builtin_popcountll(alive);
+        }
+    }
+    return count;
+}
+
+// Advance the sparse board PASSES generations
+void stepSparse() {
+    for (uint pass = 0; pass < PASSES; ++pass) {
+        SPARSE_BOARD->step();
+    }
+
+    if (SETTINGS.stats) {
+        std::cout << "Population: " << SPARSE_BOARD->population() << std::endl;
+    }
+}
+
+// Advance the chunked board PASSES generations
+void stepChunked(ThreadPool &pool) {
+    for (uint pass = 0; pass < PASSES; ++pass) {
+        CHUNKED_BOARD->step(pool);
+    }
+
+    if (SETTINGS.stats) {
+        std::cout << "Chunks: " << CHUNKED_BOARD->chunks()
+                  << " Population: " << CHUNKED_BOARD->population() << std::endl;
+    }
+}
+
+// Tasks run and stolen by each thread since the last call
+void printPoolStats(ThreadPool &pool) {
+    std::cout << "Tasks run/stolen:";
+    for (uint w = 0; w < pool.size(); ++w) {
+        std::cout << " " << pool.executed(w) << "/" << pool.stolen(w);
+    }
+    std::cout << std::endl;
+    pool.resetCounters();
 }
 
 void parseInput(char key) {
@@ -137,7 +406,7 @@ void parseInput(char key) {
             break;
         case 'w':
             // UP
-            POS_Y = (POS_Y == 0) ? POS_Y : POS_Y - 10;
+            POS_Y -= 10;
             move=true;
             break;
         case 's':
@@ -152,7 +421,7 @@ void parseInput(char key) {
             break;
         case 'a':
             // LEFT
-            POS_X = (POS_X == 0) ? POS_X : POS_X - 10;
+            POS_X -= 10;
             move=true;
             break;
         case 'p':
@@ -162,55 +431,283 @@ void parseInput(char key) {
     }
 
     if (move) {
-        // Check if we have viewed greater than board space
-        if ((POS_Y + SCREEN_Y / BOARD_TIMES_Y) > BOARD_Y) {
-            POS_Y = SCREEN_Y - (BOARD_Y / BOARD_TIMES_Y);
-        }
-        if ((POS_X + SCREEN_X / BOARD_TIMES_X) > BOARD_X) {
-            POS_X = SCREEN_X - (BOARD_X / BOARD_TIMES_X);
+        // Check if we have viewed greater than board space, the chunked
+        // plane has no edges to stop at
+        if (CHUNKED_BOARD == nullptr) {
+            if ((POS_Y + SCREEN_Y / BOARD_TIMES_Y) > BOARD_Y) {
+                POS_Y = BOARD_Y - (SCREEN_Y / BOARD_TIMES_Y);
+            }
+            if ((POS_X + SCREEN_X / BOARD_TIMES_X) > BOARD_X) {
+                POS_X = BOARD_X - (SCREEN_X / BOARD_TIMES_X);
+            }
+            POS_Y = std::max(POS_Y, (lint) 0);
+            POS_X = std::max(POS_X, (lint) 0);
         }
 
+        renderView();
         drawBoard(0, 0, SCREEN_X, SCREEN_Y);
     }
 }
 
-void spawnGlider(uint x, uint y, bool *VIRTUAL_BOARD) {
+// Board is a BitBoard, MortonBoard, FileBoard, SparseBoard or ChunkedBoard
+template <class Board>
+void spawnGlider(uint x, uint y, Board *board) {
     if (x + 3 >= BOARD_X || y + 3 >= BOARD_Y) {
         std::cout << "Unable to set glider at: " << x << ", " << y << std::endl;
         return;
     }
 
-    VIRTUAL_BOARD[x + (y * BOARD_X)] = 1;
-    VIRTUAL_BOARD[x + 1 + (y + 1 * BOARD_X)] = 1;
-    VIRTUAL_BOARD[x + 2 + (y + 1 * BOARD_X)] = 1;
-    VIRTUAL_BOARD[x + (y + 2 * BOARD_X)] = 1;
-    VIRTUAL_BOARD[x + 1 + (y + 2 * BOARD_X)] = 1;
+    board->set(x, y);
+    board->set(x + 1, y + 1);
+    board->set(x + 2, y + 1);
+    board->set(x, y + 2);
+    board->set(x + 1, y + 2);
+}
+
+// This rank's strip of the board, set with board coordinates
+struct StripBoard {
+    inline void set(uint x, uint y) {
+        if (x < BOARD_X && y >= STRIP_FIRST && y < STRIP_FIRST + STRIP_ROWS) {
+            VIRTUAL_BOARD->set(x, y - STRIP_FIRST + RANGE);
+        }
+    }
+};
+
+// Clamp STEPS to what the rule can do in one pass and set RANGE
+void setupRange(uint planes) {
+    if (planes > 1 && STEPS > 1) {
+        std::cout << "Temporal blocking only supports two states" << std::endl;
+        STEPS = 1;
+    }
+    if (SETTINGS.ltl.radius > 0 && STEPS > 1) {
+        std::cout << "Temporal blocking does not support Larger than Life" << std::endl;
+        STEPS = 1;
+    }
+    RANGE = std::max(STEPS, SETTINGS.ltl.radius);
+    std::cout << "Generations per pass: " << STEPS << std::endl;
+}
+
+// Say which of --temporal, --schedule and --tile were set for an engine
+// that does not use them, each flag true if the engine ignores it. An
+// engine that ignores the tile height ignores the width too.
+void reportUnused(const char *engine, bool temporal, bool schedule, bool tileWidth, bool tileHeight) {
+    if (temporal && SETTINGS.temporal != DEFAULT_SETTINGS.temporal) {
+        std::cout << engine << " ignores --temporal" << std::endl;
+    }
+    if (schedule && SETTINGS.schedule != DEFAULT_SETTINGS.schedule) {
+        std::cout << engine << " ignores --schedule" << std::endl;
+    }
+    if (tileHeight && (SETTINGS.tileWidth != DEFAULT_SETTINGS.tileWidth
+                       || SETTINGS.tileHeight != DEFAULT_SETTINGS.tileHeight)) {
+        std::cout << engine << " ignores --tile" << std::endl;
+    } else if (tileWidth && SETTINGS.tileWidth != DEFAULT_SETTINGS.tileWidth) {
+        std::cout << engine << " only uses the height of --tile" << std::endl;
+    }
 }
 
 int main(int argc, char *argv[]) {
-    startApp();
+    parseSettings(argc, argv);
+
+    // Ranks of a cluster run without a display
+    HEADLESS = SETTINGS.headless || !SETTINGS.peers.empty();
+    if (!HEADLESS) {
+        startApp();
+    }
 
     std::cout << "Screen Size X: " << SCREEN_X << std::endl;
     std::cout << "Screen Size Y: " << SCREEN_Y << std::endl;
+    setLifeRule(SETTINGS.rule);
+    if (SETTINGS.ltl.radius > 0) {
+        std::cout << "Rule: " << ltlRuleString(SETTINGS.ltl) << std::endl;
+    } else {
+        std::cout << "Rule: " << ruleString(lifeKernel().rule) << std::endl;
+    }
+    std::cout << "Life Kernel: " << lifeKernel().name << std::endl;
+
+    // Workers live for the whole run and wait between generations
+    THREADS = SETTINGS.threads;
+    ThreadPool pool(THREADS);
+    std::cout << "Threads: " << THREADS << std::endl;
 
     // Default Board size should always be greater or equal to screen size
+    BOARD_X = SETTINGS.boardWidth;
+    BOARD_Y = SETTINGS.boardHeight;
     BOARD_X = BOARD_X < SCREEN_X ? SCREEN_X : BOARD_X;
     BOARD_Y = BOARD_Y < SCREEN_Y ? SCREEN_Y : BOARD_Y;
+    // Whole words per row so tiles fill torus ghost cells independently
+    BOARD_X = (BOARD_X + 63) / 64 * 64;
+
+    bool twoStates = (SETTINGS.rule.states == 2 && SETTINGS.ltl.radius == 0);
+    Engine engine = SETTINGS.engine;
+    if ((engine == SPARSE || engine == CHUNKED) && !twoStates) {
+        std::cout << "Sparse and chunked engines only support two state B/S rules, using dense" << std::endl;
+        engine = DENSE;
+    }
+    if (engine == OUT_OF_CORE && SETTINGS.ltl.radius > 0) {
+        std::cout << "Out of core engine does not support Larger than Life, using dense" << std::endl;
+        engine = DENSE;
+    }
+    Layout layout = SETTINGS.layout;
+    if (layout == MORTON && !twoStates) {
+        std::cout << "Morton layout only supports two state B/S rules, using rows" << std::endl;
+        layout = ROWS;
+    }
+    if (!SETTINGS.peers.empty() && (engine != DENSE || layout != ROWS)) {
+        std::cout << "Only the dense engine with rows can be split across processes, using it" << std::endl;
+        engine = DENSE;
+        layout = ROWS;
+    }
+    if (engine == DENSE && layout == MORTON) {
+        // Whole blocks so the torus wraps at the board edge
+        BOARD_Y = (BOARD_Y + BLOCK_SIZE - 1) / BLOCK_SIZE * BLOCK_SIZE;
+    }
+    std::cout << "Board: " << BOARD_X << "x" << BOARD_Y << std::endl;
+
+    // Already checked to be 1 to MAX_TEMPORAL_STEPS
+    STEPS = SETTINGS.temporal;
+    PASSES = std::max(SETTINGS.generations, 1u);
+    setupPalette(SETTINGS.rule.states);
+
+    // Only the dense engine steps in tiles
+    TileGrid *grid = nullptr;
+    Wavefront *wavefront = nullptr;
+
+    if (engine == CHUNKED) {
+        std::cout << "Engine: chunked" << std::endl;
+        reportUnused("Chunked engine", true, true, true, true);
+        CHUNKED_BOARD = new ChunkedBoard();
+        VIEW = new BitBoard(SCREEN_X, SCREEN_Y);
+
+        loadRLE("turingmachine.rle", CHUNKED_BOARD);
+
+        // Basic intiailization
+        spawnGlider(10, 0, CHUNKED_BOARD);
+        renderView();
+    } else if (engine == OUT_OF_CORE) {
+        std::cout << "Engine: out of core, " << SETTINGS.file << std::endl;
+        // Blocks are whole rows of the tile height
+        reportUnused("Out of core engine", true, true, true, false);
+        uint planes = statePlanes(SETTINGS.rule.states);
+        // The next generation is scratch, only --file is carried on from
+        std::remove((SETTINGS.file + ".next").c_str());
+        FILE_BOARD = new FileBoard(SETTINGS.file, BOARD_X, BOARD_Y, planes);
+        FILE_BUFFER = new FileBoard(SETTINGS.file + ".next", BOARD_X, BOARD_Y, planes);
+        if (!FILE_BOARD->isOpen() || !FILE_BUFFER->isOpen()) {
+            stopRun(1);
+        }
+        VIEW = new BitBoard(SCREEN_X, SCREEN_Y, planes);
 
-    // Allocate board space
-    VIRTUAL_BOARD = new bool[BOARD_X * BOARD_Y]();
-    BOARD_BUFFER = new bool[BOARD_X * BOARD_Y]();
+        if (FILE_BOARD->isResumed()) {
+            std::cout << "Carrying on from the board in " << SETTINGS.file << std::endl;
+        } else {
+            loadRLE("turingmachine.rle", FILE_BOARD);
 
-    loadRLE("turingmachine.rle", VIRTUAL_BOARD, BOARD_X, BOARD_Y);
+            // Basic intiailization
+            spawnGlider(10, 0, FILE_BOARD);
+        }
+        renderView();
+    } else if (engine == DENSE && layout == MORTON) {
+        std::cout << "Engine: dense, Morton layout" << std::endl;
+        reportUnused("Morton layout", true, true, true, true);
+        MORTON_BOARD = new MortonBoard(BOARD_X, BOARD_Y);
+        MORTON_BUFFER = new MortonBoard(BOARD_X, BOARD_Y);
+        VIEW = new BitBoard(SCREEN_X, SCREEN_Y);
+
+        loadRLE("turingmachine.rle", MORTON_BOARD);
+
+        // Basic intiailization
+        spawnGlider(10, 0, MORTON_BOARD);
+        renderView();
+    } else if (engine == SPARSE) {
+        std::cout << "Engine: sparse" << std::endl;
+        reportUnused("Sparse engine", true, true, true, true);
+        SPARSE_BOARD = new SparseBoard(BOARD_X, BOARD_Y, SETTINGS.boundary, SETTINGS.rule);
+        VIEW = new BitBoard(SCREEN_X, SCREEN_Y);
+
+        loadRLE("turingmachine.rle", SPARSE_BOARD);
+
+        // Basic intiailization
+        spawnGlider(10, 0, SPARSE_BOARD);
+        renderView();
+    } else if (!SETTINGS.peers.empty()) {
+        CLUSTER = new Cluster(SETTINGS.rank, SETTINGS.peers, SETTINGS.boundary);
+        if (!CLUSTER->isConnected()) {
+            return 1;
+        }
 
+        // Rank r owns rows [BOARD_Y * r / ranks, BOARD_Y * (r + 1) / ranks)
+        STRIP_FIRST = (ulint) BOARD_Y * CLUSTER->rank / CLUSTER->ranks;
+        STRIP_ROWS = (ulint) BOARD_Y * (CLUSTER->rank + 1) / CLUSTER->ranks - STRIP_FIRST;
+        std::cout << "Engine: dense, rank " << CLUSTER->rank << " of " << CLUSTER->ranks
+                  << ", rows " << STRIP_FIRST << " to " << STRIP_FIRST + STRIP_ROWS << std::endl;
+        // The strip is stepped in bands of rows, temporal blocking still works
+        reportUnused("Splitting across processes", false, true, true, true);
+
+        uint planes = statePlanes(SETTINGS.rule.states);
+        setupRange(planes);
+        if (STRIP_ROWS < RANGE) {
+            std::cout << "Each rank needs at least " << RANGE << " rows" << std::endl;
+            return 1;
+        }
 
-    // Basic intiailization
-    spawnGlider(10, 0, VIRTUAL_BOARD);
+        // RANGE rows of halo above and below the strip
+        VIRTUAL_BOARD = new BitBoard(BOARD_X, STRIP_ROWS + 2 * RANGE, planes);
+        BOARD_BUFFER = new BitBoard(BOARD_X, STRIP_ROWS + 2 * RANGE, planes);
+
+        // Every rank reads the whole pattern and keeps its own rows
+        StripBoard strip;
+        uint size_x, size_y;
+        parseRLE("turingmachine.rle", size_x, size_y, [&strip](uint x, uint y) {
+            strip.set(x, y);
+        });
+
+        // Basic intiailization
+        spawnGlider(10, 0, &strip);
+    } else {
+        std::cout << "Engine: dense" << std::endl;
+
+        bool inplace = SETTINGS.inplace;
+        if (inplace && (SETTINGS.ltl.radius > 0 || STEPS > 1)) {
+            std::cout << "In place update does not support temporal blocking or Larger than Life" << std::endl;
+            inplace = false;
+        }
+
+        // Allocate board space, a plane for every bit of the cell state
+        uint planes = statePlanes(SETTINGS.rule.states);
+        VIRTUAL_BOARD = new BitBoard(BOARD_X, BOARD_Y, planes);
+
+        loadRLE("turingmachine.rle", VIRTUAL_BOARD);
+
+        if (inplace) {
+            // Stripes of whole rows, all stepped on the one board
+            grid = new TileGrid(*VIRTUAL_BOARD, BOARD_X, SETTINGS.tileHeight);
+            STRIPE_EDGES = new StripeEdges(*VIRTUAL_BOARD, *grid);
+            std::cout << "In place stripes: " << grid->rows << std::endl;
+            // Stripes are stepped in order, the --temporal message is above
+            reportUnused("In place update", false, true, true, false);
+        } else {
+            BOARD_BUFFER = new BitBoard(BOARD_X, BOARD_Y, planes);
+
+            // Tiles are handed out to the pool as threads free up
+            grid = new TileGrid(*VIRTUAL_BOARD, SETTINGS.tileWidth, SETTINGS.tileHeight);
+            std::cout << "Tiles: " << grid->columns << "x" << grid->rows << std::endl;
+
+            setupRange(planes);
+            wavefront = new Wavefront(*grid, SETTINGS.boundary, grid->reach(RANGE));
+        }
+
+        // Basic intiailization
+        spawnGlider(10, 0, VIRTUAL_BOARD);
+    }
+    std::cout << "Passes per frame: " << PASSES << std::endl;
 
     // FPS Logic: https://stackoverflow.com/questions/38730273/how-to-limit-fps-in-a-loop-with-c
     std::chrono::system_clock::time_point a = std::chrono::system_clock::now();
     std::chrono::system_clock::time_point b = std::chrono::system_clock::now();
 
+    // Frames stepped, the loop only ends after SETTINGS.frames
+    uint frame = 0;
+
     // Game Loop
     for(;;) {
         a = std::chrono::system_clock::now();
@@ -231,25 +728,57 @@ int main(int argc, char *argv[]) {
         #endif
 
         // Map board to display
-        parseInput(getKeyPress());
+        if (!HEADLESS) {
+            parseInput(getKeyPress());
+        }
 
         if (!PAUSE) {
-            // Update board
-            std::vector<std::thread> threads;
-            for (uint t = 0; t < THREADS; ++t) {
-                // Create overlap
-                threads.push_back(std::thread(
-                    updateBoard,
-                    VIRTUAL_BOARD,
-                    BOARD_BUFFER,
-                    t
-                ));
+            if (CLUSTER != nullptr) {
+                if (!stepCluster(pool)) {
+                    std::cout << "Stopping, rank " << CLUSTER->rank << " can no longer reach its neighbours" << std::endl;
+                    stopRun(1);
+                }
+            } else if (CHUNKED_BOARD != nullptr) {
+                stepChunked(pool);
+            } else if (SPARSE_BOARD != nullptr) {
+                stepSparse();
+            } else if (MORTON_BOARD != nullptr) {
+                stepMortonBoard(pool);
+            } else if (FILE_BOARD != nullptr) {
+                if (!stepOutOfCore(pool)) {
+                    std::cout << "Stopping, the board files can no longer be trusted" << std::endl;
+                    stopRun(1);
+                }
+            } else if (STRIPE_EDGES != nullptr) {
+                stepInPlace(pool, *grid);
+            } else if (SETTINGS.schedule == WAVEFRONT) {
+                stepWavefront(pool, *grid, *wavefront);
+            } else {
+                stepBarrier(pool, *grid);
+            }
+
+            if (SETTINGS.stats) {
+                printPoolStats(pool);
             }
 
-            for (uint t = 0; t < THREADS; ++t) {
-                threads.at(t).join();
+            if (SETTINGS.frames != 0 && ++frame >= SETTINGS.frames) {
+                break;
             }
+            if (HEADLESS) {
+                continue;
+            }
+
+            renderView();
 
+            if (BOARD_TIMES_X == 1 && BOARD_TIMES_Y == 1) {
+                // Stripe edges are rounded so the rows left over when
+                // the screen does not divide evenly are still drawn
+                pool.run(THREADS, [](uint t) {
+                    uint startY = (ulint) SCREEN_Y * t / THREADS;
+                    uint endY = (ulint) SCREEN_Y * (t + 1) / THREADS;
+                    drawBoard(0, startY, SCREEN_X, endY - startY);
+                });
+            }
         }
 
         // Support only multi thread draw on none zoom mode
@@ -259,6 +788,14 @@ int main(int argc, char *argv[]) {
         }
     }
 
-    // This should never reach
-    closeApp(9);
+    if (CLUSTER != nullptr) {
+        std::cout << "Rank " << CLUSTER->rank << " compute: " << COMPUTE_MS << " ms wait: " << WAIT_MS
+                  << " ms population: " << stripPopulation() << std::endl;
+        delete CLUSTER;
+    }
+
+    if (HEADLESS) {
+        return 0;
+    }
+    closeApp(0);
 }
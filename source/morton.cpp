@@ -0,0 +1,238 @@
+/***********************************************
+ * Project: RaspberryConway
+ * File: morton.cpp
+ * By: ProgrammingIncluded
+ * Website: ProgrammingIncluded.github.io
+ * License: GNU GPLv3 (see LICENSE file)
+***********************************************/
+
+#include "morton.hpp"
+#include "kernel_impl.hpp"
+#include "quadtree.hpp"
+#include "gendata.hpp"
+
+#include <cstring>
+#include <vector>
+
+// Bits of a Morton index holding x and y
+static const uint64_t X_BITS = 0xAAAAAAAAAAAAAAAAull;
+static const uint64_t Y_BITS = 0x5555555555555555ull;
+
+// Cells in the first and last column of a block
+static const uint64_t WEST_COLUMN = 0x0101010101010101ull;
+static const uint64_t EAST_COLUMN = WEST_COLUMN << 7;
+
+// Neighbouring blocks by adding to one coordinate in place. Filling the
+// bits of the other coordinate with ones carries straight across them.
+static inline uint64_t eastIndex(uint64_t m) {
+    return (((m | Y_BITS) + 1) & X_BITS) | (m & Y_BITS);
+}
+
+static inline uint64_t westIndex(uint64_t m) {
+    return (((m & X_BITS) - 1) & X_BITS) | (m & Y_BITS);
+}
+
+static inline uint64_t southIndex(uint64_t m) {
+    return (((m | X_BITS) + 1) & Y_BITS) | (m & X_BITS);
+}
+
+static inline uint64_t northIndex(uint64_t m) {
+    return (((m & Y_BITS) - 1) & Y_BITS) | (m & X_BITS);
+}
+
+// Align the cells west, east, north and south of every cell of a block
+// with the cell, taking the cells past its edge from the next block
+static inline uint64_t westOfBlock(uint64_t block, uint64_t west) {
+    return ((block << 1) & ~WEST_COLUMN) | ((west >> 7) & WEST_COLUMN);
+}
+
+static inline uint64_t eastOfBlock(uint64_t block, uint64_t east) {
+    return ((block >> 1) & ~EAST_COLUMN) | ((east << 7) & EAST_COLUMN);
+}
+
+static inline uint64_t northOfBlock(uint64_t block, uint64_t north) {
+    return (block << 8) | (north >> 56);
+}
+
+static inline uint64_t southOfBlock(uint64_t block, uint64_t south) {
+    return (block >> 8) | (south << 56);
+}
+
+MortonBoard::MortonBoard(uint width, uint height) {
+    this->width = width;
+    this->height = height;
+    this->blocksX = (width + BLOCK_SIZE - 1) / BLOCK_SIZE;
+    this->blocksY = (height + BLOCK_SIZE - 1) / BLOCK_SIZE;
+
+    this->side = 1;
+    while (this->side < this->blocksX || this->side < this->blocksY) {
+        this->side *= 2;
+    }
+    this->blocks = new uint64_t[this->size()]();
+}
+
+MortonBoard::~MortonBoard() {
+    delete[] this->blocks;
+}
+
+void MortonBoard::clear() {
+    memset(this->blocks, 0, sizeof(uint64_t) * this->size());
+}
+
+void MortonBoard::render(BitBoard &view, uint x, uint y) const {
+    view.clear();
+
+    for (uint vy = 0; vy < view.height && y + vy < this->height; ++vy) {
+        uint cy = y + vy;
+        uint shift = (cy & 7) << 3;
+        uint64_t *out = view.row(vy);
+
+        // A row of a block is a byte, placed wherever it lands in the view
+        for (uint bx = x / BLOCK_SIZE; bx < this->blocksX; ++bx) {
+            lint left = (lint) bx * BLOCK_SIZE - x;
+            if (left >= view.width) {
+                break;
+            }
+
+            uint64_t cells = (this->blocks[index(bx, cy >> 3)] >> shift) & 0xFF;
+            if (cells == 0) {
+                continue;
+            }
+
+            if (left < 0) {
+                out[0] |= cells >> -left;
+                continue;
+            }
+
+            out[left >> 6] |= cells << (left & 63);
+            if ((left & 63) > 56 && (left >> 6) + 1 < view.stride) {
+                out[(left >> 6) + 1] |= cells >> (64 - (left & 63));
+            }
+        }
+
+        out[view.stride - 1] &= view.lastMask;
+    }
+}
+
+void MortonBoard::toQuadTree(QuadTree &tree) const {
+    // Squares still waiting on the rest of the square they are a quarter
+    // of, which come next in Morton order
+    std::vector<GenData*> pending;
+    uint level = LEAF_LEVEL;
+
+    for (uint64_t m = 0; m < this->size(); ++m) {
+        // Blocks have the same layout as leaves
+        pending.push_back(getLeaf(this->blocks[m]));
+
+        // Every fourth square finishes the one above it, in the order nw,
+        // sw, ne, se
+        for (uint64_t done = m + 1; done % 4 == 0; done /= 4) {
+            GenData **q = &pending[pending.size() - 4];
+            GenData *square = join(q[0], q[2], q[1], q[3]);
+            pending.resize(pending.size() - 4);
+            pending.push_back(square);
+        }
+    }
+
+    for (uint64_t s = this->side; s > 1; s /= 2) {
+        ++level;
+    }
+    tree.setRoot(pending.back(), level, 0, 0);
+}
+
+// Block at bx, by of a board past its edges, 0 if dead
+static inline uint64_t blockAt(const MortonBoard &board, lint bx, lint by, Boundary boundary) {
+    if (boundary == TORUS) {
+        bx = (bx + board.blocksX) % board.blocksX;
+        by = (by + board.blocksY) % board.blocksY;
+    } else if (bx < 0 || by < 0 || bx >= board.blocksX || by >= board.blocksY) {
+        return 0;
+    }
+    return board.blocks[MortonBoard::index(bx, by)];
+}
+
+template <class R>
+static bool stepBlocks(
+    const MortonBoard &src, MortonBoard &dst,
+    uint64_t first, uint64_t last, Boundary boundary, const Rule &rule
+) {
+    const uint64_t *blocks = src.blocks;
+    uint64_t diff = 0;
+
+    // Dilated numbers keep their order, so the coordinates can be checked
+    // without pulling them out of the index
+    uint64_t endX = MortonBoard::index(src.blocksX, 0);
+    uint64_t endY = MortonBoard::index(0, src.blocksY);
+    uint64_t lastX = MortonBoard::index(src.blocksX - 1, 0);
+    uint64_t lastY = MortonBoard::index(0, src.blocksY - 1);
+
+    for (uint64_t m = first; m < last; ++m) {
+        uint64_t mx = m & X_BITS;
+        uint64_t my = m & Y_BITS;
+        if (mx >= endX || my >= endY) {
+            continue;
+        }
+
+        uint64_t nw, nn, ne, ww, ee, sw, ss, se;
+        if (mx != 0 && my != 0 && mx != lastX && my != lastY) {
+            // Inside the board every neighbour is a few bit operations away
+            uint64_t n = northIndex(m), s = southIndex(m);
+            nw = blocks[westIndex(n)];
+            nn = blocks[n];
+            ne = blocks[eastIndex(n)];
+            ww = blocks[westIndex(m)];
+            ee = blocks[eastIndex(m)];
+            sw = blocks[westIndex(s)];
+            ss = blocks[s];
+            se = blocks[eastIndex(s)];
+        } else {
+            uint bx = undilate(m >> 1);
+            uint by = undilate(m);
+            nw = blockAt(src, (lint) bx - 1, (lint) by - 1, boundary);
+            nn = blockAt(src, bx, (lint) by - 1, boundary);
+            ne = blockAt(src, bx + 1, (lint) by - 1, boundary);
+            ww = blockAt(src, (lint) bx - 1, by, boundary);
+            ee = blockAt(src, bx + 1, by, boundary);
+            sw = blockAt(src, (lint) bx - 1, by + 1, boundary);
+            ss = blockAt(src, bx, by + 1, boundary);
+            se = blockAt(src, bx + 1, by + 1, boundary);
+        }
+
+        uint64_t cc = blocks[m];
+        uint64_t w = westOfBlock(cc, ww), e = eastOfBlock(cc, ee);
+        uint64_t wn = westOfBlock(nn, nw), en = eastOfBlock(nn, ne);
+        uint64_t ws = westOfBlock(ss, sw), es = eastOfBlock(ss, se);
+
+        uint64_t next = R::word(
+            northOfBlock(w, wn), northOfBlock(cc, nn), northOfBlock(e, en),
+            w, cc, e,
+            southOfBlock(w, ws), southOfBlock(cc, ss), southOfBlock(e, es),
+            rule
+        );
+
+        dst.blocks[m] = next;
+        diff |= next ^ cc;
+    }
+
+    return diff != 0;
+}
+
+bool stepMorton(
+    const MortonBoard &src, MortonBoard &dst,
+    uint64_t first, uint64_t last, Boundary boundary
+) {
+    const Rule &rule = lifeKernel().rule;
+    if (rule == CONWAY) {
+        return stepBlocks<FixedRule<CONWAY.birth, CONWAY.survive>>(src, dst, first, last, boundary, rule);
+    }
+    if (rule == HIGHLIFE) {
+        return stepBlocks<FixedRule<HIGHLIFE.birth, HIGHLIFE.survive>>(src, dst, first, last, boundary, rule);
+    }
+    if (rule == DAY_AND_NIGHT) {
+        return stepBlocks<FixedRule<DAY_AND_NIGHT.birth, DAY_AND_NIGHT.survive>>(src, dst, first, last, boundary, rule);
+    }
+    if (rule == SEEDS) {
+        return stepBlocks<FixedRule<SEEDS.birth, SEEDS.survive>>(src, dst, first, last, boundary, rule);
+    }
+    return stepBlocks<AnyRule>(src, dst, first, last, boundary, rule);
+}
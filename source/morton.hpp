@@ -0,0 +1,111 @@
+/***********************************************
+ * Project: RaspberryConway
+ * File: morton.hpp
+ * By: ProgrammingIncluded
+ * Website: ProgrammingIncluded.github.io
+ * License: GNU GPLv3 (see LICENSE file)
+***********************************************/
+#ifndef MORTON_HPP
+#define MORTON_HPP
+
+#include "bitboard.hpp"
+#include "rule.hpp"
+
+#include <cstdint>
+
+typedef long long int lint;
+
+class QuadTree;
+
+// Cells per side of a block
+const uint BLOCK_SIZE = 8;
+
+// Spread the bits of v out to every other bit, bit i moves to bit 2i
+inline uint64_t dilate(uint32_t v) {
+    uint64_t d = v;
+    d = (d | (d << 16)) & 0x0000FFFF0000FFFFull;
+    d = (d | (d << 8)) & 0x00FF00FF00FF00FFull;
+    d = (d | (d << 4)) & 0x0F0F0F0F0F0F0F0Full;
+    d = (d | (d << 2)) & 0x3333333333333333ull;
+    d = (d | (d << 1)) & 0x5555555555555555ull;
+    return d;
+}
+
+// Inverse of dilate, gathers the even bits of d
+inline uint32_t undilate(uint64_t d) {
+    d &= 0x5555555555555555ull;
+    d = (d | (d >> 1)) & 0x3333333333333333ull;
+    d = (d | (d >> 2)) & 0x0F0F0F0F0F0F0F0Full;
+    d = (d | (d >> 4)) & 0x00FF00FF00FF00FFull;
+    d = (d | (d >> 8)) & 0x0000FFFF0000FFFFull;
+    d = (d | (d >> 16)) & 0x00000000FFFFFFFFull;
+    return (uint32_t) d;
+}
+
+// Board of 8x8 blocks, each packed into a word with cell (x, y) of the
+// block in bit y * 8 + x. Blocks are stored in Morton order with x in the
+// odd bits of the index and y in the even bits, so every aligned square
+// of blocks is contiguous and its four quarters come one after the other
+// (nw, sw, ne, se), ready to be joined into a quadtree. Rows above and
+// below a block sit next to it in memory instead of a row away.
+//
+// The blocks fill a power of two square, blocks past the width or height
+// are never stepped and stay dead. Two state rules only.
+class MortonBoard {
+    public:
+        // Cells, multiples of BLOCK_SIZE
+        uint width;
+        uint height;
+        uint blocksX;
+        uint blocksY;
+        // Blocks per side of the square holding the board
+        uint side;
+        // side * side blocks in Morton order
+        uint64_t *blocks;
+
+        MortonBoard(uint width, uint height);
+        ~MortonBoard();
+
+        static inline uint64_t index(uint blockX, uint blockY) {
+            return (dilate(blockX) << 1) | dilate(blockY);
+        }
+
+        inline uint64_t size() const {
+            return (uint64_t) this->side * this->side;
+        }
+
+        inline bool get(uint x, uint y) const {
+            uint64_t block = this->blocks[index(x >> 3, y >> 3)];
+            return (block >> (((y & 7) << 3) | (x & 7))) & 1;
+        }
+
+        inline void set(uint x, uint y, bool alive = true) {
+            uint64_t &block = this->blocks[index(x >> 3, y >> 3)];
+            uint64_t bit = (uint64_t) 1 << (((y & 7) << 3) | (x & 7));
+            block = alive ? (block | bit) : (block & ~bit);
+        }
+
+        void clear();
+
+        // Draw the cells from (x, y) to (x + view.width, y + view.height)
+        // into view, anything else in view is cleared
+        void render(BitBoard &view, uint x, uint y) const;
+
+        // Replace the cells of tree with the board, its top left at 0, 0,
+        // in a single pass over the blocks. Each square of blocks is
+        // joined as soon as its last quarter is seen.
+        void toQuadTree(QuadTree &tree) const;
+
+    private:
+        // Disallow copy constructor
+        MortonBoard(const MortonBoard&) = delete;
+};
+
+// Step the blocks with Morton index in [first, last) of src into dst
+// with the rule of lifeKernel(). Returns true if any of them changed.
+bool stepMorton(
+    const MortonBoard &src, MortonBoard &dst,
+    uint64_t first, uint64_t last, Boundary boundary
+);
+
+#endif /* MORTON_HPP */
@@ -1,403 +1,349 @@
 #include "quadtree.hpp"
 
+#include <algorithm>
 #include <vector>
 #include <iostream>
 #include <climits>
-#include "game.hpp"
+#include "gendata.hpp"
+#include "kernel.hpp"
+#include "threadpool.hpp"
 
-// Though QuadTrees can be infinite in nature
-// simplify implementation by assuming a very large board space
-// 2^16 roughly 16 deep
-static const lint MAX_TREE_BOARD = 65536;
-static const lint MIN_TREE_BOARD = -65536;
+// Smallest root, big enough that the quadrants of its quadrants are at
+// least leaves
+static const uint MIN_LEVEL = LEAF_LEVEL + 2;
 
-QuadTree::QuadTree() {
-    this->uidCounter = 0;
-    QuadNode *root = new QuadNode();
-    // Make range the largest it can be
-    Range range = {MIN_TREE_BOARD, MIN_TREE_BOARD, MAX_TREE_BOARD, MAX_TREE_BOARD};
-    root->id = (this->uidCounter)++;
-    root->range = range;
-    root->parent = nullptr;
-    root->children = nullptr;
-    root->isLeaf = false;
-    root->sideLength = range.endX - range.startX;
-    // Set to atleast one
-    root->pixelCount = 1;
-    root->gd = nullptr;
+// Blocks this big or bigger step their parts as tasks of their own when
+// given a pool, smaller ones are not worth the overhead of a task
+static const uint SPAWN_LEVEL = 8;
 
-    this->root = root;
-    this->bounds = range;
+// Rows and columns 0 to 3 of a leaf
+static const uint64_t QUARTER = 0x0F0F0F0FULL;
 
-    this->nullData = setupNullData();
+// Block straddling the edge between a west and an east block
+static inline GenData *horizontal(GenData *w, GenData *e) {
+    return join(w->ne, e->nw, w->se, e->sw);
 }
 
-QuadTree::~QuadTree() {
-    removeNode(this->root);
+// Block straddling the edge between a north and a south block
+static inline GenData *vertical(GenData *n, GenData *s) {
+    return join(n->sw, n->se, s->nw, s->ne);
 }
 
-GenData* QuadTree::nextGeneration(QuadNode *node) {
-    if (node == nullptr) {
-        return this->nullData;
-    } else if (node->gd != nullptr) {
-        return node->gd;
+// Middle half of the block made of four blocks of the given level
+static inline GenData *centre(GenData *nw, GenData *ne, GenData *sw, GenData *se, uint level) {
+    if (level == LEAF_LEVEL) {
+        return getLeaf(
+            ((nw->cells >> 36) & QUARTER) | (((ne->cells >> 32) & QUARTER) << 4) |
+            (((sw->cells >> 4) & QUARTER) << 32) | ((se->cells & QUARTER) << 36)
+        );
     }
-    else if (node->sideLength == 2) {
-        // Return all dead cells
-        if (node->children == nullptr) {
-            return this->nullData;
-        }
-
-        // Just set the data for future iterations
-        char data = 0;
-        data |= ((bool) (node->children[0].pixelCount)) << 3; // nw
-        data |= ((bool) (node->children[2].pixelCount)) << 2; // ne
-        data |= ((bool) (node->children[1].pixelCount)) << 1; // sw
-        data |= ((bool) (node->children[1].pixelCount)); // se
+    return join(nw->se, ne->sw, sw->ne, se->nw);
+}
 
-        GenData *cached = getBasis(data);
-        node->gd = cached;
-        return cached;
+// Middle leaf of four leaves after 1, 2 or 4 generations of the rule of
+// lifeKernel(). A row of 16 cells to a word, the whole row stepped at
+// once. Cells at the edge have no neighbours outside, so each generation
+// leaves a row and column less of the block right, which still leaves the
+// middle after 4.
+static uint64_t stepLeaves(GenData *nw, GenData *ne, GenData *sw, GenData *se, uint generations) {
+    const Rule &rule = lifeKernel().rule;
+    bool conway = (rule == CONWAY);
+
+    uint32_t rows[2 * LEAF_SIZE];
+    for (uint y = 0; y < LEAF_SIZE; ++y) {
+        uint shift = y * LEAF_SIZE;
+        rows[y] = ((nw->cells >> shift) & 0xFF) | (((ne->cells >> shift) & 0xFF) << LEAF_SIZE);
+        rows[y + LEAF_SIZE] = ((sw->cells >> shift) & 0xFF) | (((se->cells >> shift) & 0xFF) << LEAF_SIZE);
     }
-    else if (node->sideLength == 4) {
-        if (node->children == nullptr) {
-            return this->nullData;
-        }
-
-        GenData d = {0};
 
-        // Get gen data from length of side 4
-        d.nw = nextGeneration(node->children);
-        d.sw = nextGeneration(node->children + 1);
-        d.ne = nextGeneration(node->children + 2);
-        d.se = nextGeneration(node->children + 3);
-
-        GenData *cached;
-        if (!getGenData(&cached, d)) {
-            // Set data bits for new center if not cached
-            cached->data = life_4(d.nw, d.ne, d.sw, d.se);
+    uint32_t next[2 * LEAF_SIZE];
+    for (uint g = 1; g <= generations; ++g) {
+        for (uint y = g; y < 2 * LEAF_SIZE - g; ++y) {
+            uint32_t u = rows[y - 1];
+            uint32_t m = rows[y];
+            uint32_t d = rows[y + 1];
+            next[y] = conway
+                ? lifeWord(
+                    u << 1, u, u >> 1,
+                    m << 1, m, m >> 1,
+                    d << 1, d, d >> 1
+                )
+                : lifeWordGeneric(
+                    u << 1, u, u >> 1,
+                    m << 1, m, m >> 1,
+                    d << 1, d, d >> 1,
+                    rule.birth, rule.survive
+                );
         }
-
-        // Set to node for easier retrieval
-        node->gd = cached;
-        return cached;
+        std::copy(next + g, next + 2 * LEAF_SIZE - g, rows + g);
     }
 
-    // Everything else, go two t
-    if(node->children == nullptr) {
-        return this->nullData;
+    uint64_t cells = 0;
+    uint quarter = LEAF_SIZE / 2;
+    for (uint y = 0; y < LEAF_SIZE; ++y) {
+        cells |= (uint64_t) ((rows[y + quarter] >> quarter) & 0xFF) << (y * LEAF_SIZE);
     }
+    return cells;
+}
 
-    QuadNode *nwNode = node->children;
-    QuadNode *swNode = node->children + 1;
-    QuadNode *neNode = node->children + 2;
-    QuadNode *seNode = node->children + 3;
-
-    // Grab length 4 centers
-    GenData result = {0};
-    result.nw = nextGeneration(nwNode);
-    result.sw = nextGeneration(swNode);
-    result.ne = nextGeneration(neNode);
-    result.se = nextGeneration(seNode);
-
-    GenData *cached;
-
-    // Generate missing sides
-    GenData nn = {0};
-    nn.nw = result.nw;
-    nn.ne = result.ne;
-    nn.sw = result.nw;
-    nn.se = result.ne;
-
-    // Check cache
-    if(!getGenData(&cached, nn)) {
-        cached->data = life_4(result.nw, result.ne, result.nw, result.ne);
+// Call task(i) for every i in [0, tasks), forked across the pool if
+// there is one and the block is big enough
+template <class F>
+static inline void each(ThreadPool *pool, uint level, uint tasks, const F &task) {
+    if (pool == nullptr || level < SPAWN_LEVEL) {
+        for (uint i = 0; i < tasks; ++i) {
+            task(i);
+        }
+        return;
     }
+    pool->fork(tasks, task);
+}
 
-    result.nn = cached;
-
-    GenData ss = {0};
-    nn.nw = result.sw;
-    nn.ne = result.se;
-    nn.sw = result.sw;
-    nn.se = result.se;
-
-    // Check cache
-    if(!getGenData(&cached, ss)) {
-        cached->data = life_4(result.sw, result.se, result.sw, result.se);
+// Middle half of a block of the given level stepExponent() generations
+// on, or as many as it can, kept on the block
+static GenData *result(GenData *node, uint level, ThreadPool *pool) {
+    GenData *found = getResult(node);
+    if (found != nullptr) {
+        return found;
     }
 
-    result.ss = cached;
-
-    GenData cc = {0};
-    nn.nw = result.nw;
-    nn.ne = result.ne;
-    nn.sw = result.sw;
-    nn.se = result.se;
-
-    // Check cache
-    if(!getGenData(&cached, cc)) {
-        cached->data = life_4(result.nw, result.ne, result.sw, result.se);
+    if (level == LEAF_LEVEL + 1) {
+        uint generations = 1 << std::min(stepExponent(), level - 2);
+        found = getLeaf(stepLeaves(node->nw, node->ne, node->sw, node->se, generations));
+        setResult(node, found);
+        return found;
     }
 
-    result.cc = cached;
-
-    GenData ee = {0};
-    nn.nw = result.nw;
-    nn.ne = result.nw;
-    nn.sw = result.sw;
-    nn.se = result.sw;
-
-    // Check cache
-    if(!getGenData(&cached, ee)) {
-        cached->data = life_4(result.ne, result.ne, result.se, result.se);
+    // Nine overlapping blocks of the level below, each a quarter of the
+    // way across from the last, stepped on their own
+    GenData *parts[9] = {
+        node->nw, horizontal(node->nw, node->ne), node->ne,
+        vertical(node->nw, node->sw), join(node->nw->se, node->ne->sw, node->sw->ne, node->se->nw), vertical(node->ne, node->se),
+        node->sw, horizontal(node->sw, node->se), node->se
+    };
+    GenData *r[9];
+    each(pool, level, 9, [&parts, &r, level, pool](uint i) {
+        r[i] = result(parts[i], level - 1, pool);
+    });
+
+    if (level - 2 <= stepExponent()) {
+        // Each group of four is stepped again, doubling the generations
+        GenData *groups[4] = {
+            join(r[0], r[1], r[3], r[4]), join(r[1], r[2], r[4], r[5]),
+            join(r[3], r[4], r[6], r[7]), join(r[4], r[5], r[7], r[8])
+        };
+        GenData *stepped[4];
+        each(pool, level, 4, [&groups, &stepped, level, pool](uint i) {
+            stepped[i] = result(groups[i], level - 1, pool);
+        });
+        found = join(stepped[0], stepped[1], stepped[2], stepped[3]);
+    } else {
+        // Or their middles make up the middle of the block
+        uint below = level - 2;
+        found = join(
+            centre(r[0], r[1], r[3], r[4], below), centre(r[1], r[2], r[4], r[5], below),
+            centre(r[3], r[4], r[6], r[7], below), centre(r[4], r[5], r[7], r[8], below)
+        );
     }
 
-    result.ee = cached;
-
-    GenData ww = {0};
-    nn.nw = result.nw;
-    nn.ne = result.ne;
-    nn.sw = result.sw;
-    nn.se = result.se;
+    setResult(node, found);
+    return found;
+}
 
-    // Check cache
-    if(!getGenData(&cached, ww)) {
-        cached->data = life_4(result.nw, result.nw, result.sw, result.sw);
+// Block with the cell x, y from its top left set
+static GenData *setCell(GenData *node, uint level, lint x, lint y) {
+    if (level == LEAF_LEVEL) {
+        return getLeaf(node->cells | (uint64_t) 1 << (y * LEAF_SIZE + x));
     }
 
-    result.ww = cached;
-
-    GenData *resultCached;
-    getGenData(&resultCached, result);
-    return resultCached;
-
-    // nn->data |= (bool) (result->nw->ne->data & 0b00000001) << 3; // nw
-    // nn->data |= (bool) (result->ne->nw->data & 0b00000010) << 2; // ne
-    // nn->data |= (bool) (result->nw->se->data & 0b00000100) << 1; // sw
-    // nn->data |= (bool) (result->ne->sw->data & 0b00001000); // se
+    lint half = (lint) 1 << (level - 1);
+    if (y < half) {
+        if (x < half) {
+            return join(setCell(node->nw, level - 1, x, y), node->ne, node->sw, node->se);
+        }
+        return join(node->nw, setCell(node->ne, level - 1, x - half, y), node->sw, node->se);
+    }
+    if (x < half) {
+        return join(node->nw, node->ne, setCell(node->sw, level - 1, x, y - half), node->se);
+    }
+    return join(node->nw, node->ne, node->sw, setCell(node->se, level - 1, x - half, y - half));
+}
 
-    // ss->data |= (bool) (result->sw->ne->data & 0b00000001) << 3; // nw
-    // ss->data |= (bool) (result->se->nw->data & 0b00000010) << 2; // ne
-    // ss->data |= (bool) (result->sw->se->data & 0b00000100) << 1; // sw
-    // ss->data |= (bool) (result->se->sw->data & 0b00001000); // se
+QuadTree::QuadTree() {
+    this->nullData = setupNullData();
+    this->generation = 0;
+    this->setRoot(this->nullData, MIN_LEVEL, 0, 0);
+    addRoot(&this->root);
+}
 
-    // ee->data |= (bool) (result->ne->sw->data & 0b00000001) << 3; // nw
-    // ee->data |= (bool) (result->ne->se->data & 0b00000010) << 2; // ne
-    // ee->data |= (bool) (result->se->nw->data & 0b00000100) << 1; // sw
-    // ee->data |= (bool) (result->se->ne->data & 0b00001000); // se
+QuadTree::~QuadTree() {
+    removeRoot(&this->root);
+}
 
-    // ww->data |= (bool) (result->nw->sw->data & 0b00000001) << 3; // nw
-    // ww->data |= (bool) (result->nw->se->data & 0b00000010) << 2; // ne
-    // ww->data |= (bool) (result->sw->nw->data & 0b00000100) << 1; // sw
-    // ww->data |= (bool) (result->sw->ne->data & 0b00001000); // se
+void QuadTree::setRoot(GenData *root, uint level, lint x, lint y) {
+    // Smaller roots become the top left of one big enough
+    for (; level < MIN_LEVEL; ++level) {
+        root = join(root, this->nullData, this->nullData, this->nullData);
+    }
+    this->root = root;
+    this->level = level;
+    this->originX = x;
+    this->originY = y;
+}
 
-    // cc->data |= (bool) (result->nw->se->data & 0b00000001) << 3; // nw
-    // cc->data |= (bool) (result->ne->sw->data & 0b00000010) << 2; // ne
-    // cc->data |= (bool) (result->sw->ne->data & 0b00000100) << 1; // sw
-    // cc->data |= (bool) (result->se->nw->data & 0b00001000); // se
+void QuadTree::expand() {
+    GenData *e = this->nullData;
+    GenData *cur = this->root;
+    this->root = join(
+        join(e, e, e, cur->nw), join(e, e, cur->ne, e),
+        join(e, cur->sw, e, e), join(cur->se, e, e, e)
+    );
+
+    lint quarter = (lint) 1 << (this->level - 1);
+    this->originX -= quarter;
+    this->originY -= quarter;
+    ++this->level;
 }
 
-void QuadTree::addPixel(lint x, lint y) {
-    QuadNode *cur = this->root;
-    for(;;) {
-
-        // Don't traverse if we've hit the single digit which is a leaf
-        if (cur->isLeaf) {
-            // Set pixel count to 1 if node already exists
-            cur->pixelCount = 1;
-            return ;
-        }
+bool QuadTree::isCentred() {
+    GenData *e = this->nullData;
+    GenData *cur = this->root;
+    return
+        cur->nw->nw == e && cur->nw->ne == e && cur->nw->sw == e &&
+        cur->ne->nw == e && cur->ne->ne == e && cur->ne->se == e &&
+        cur->sw->nw == e && cur->sw->sw == e && cur->sw->se == e &&
+        cur->se->ne == e && cur->se->sw == e && cur->se->se == e;
+}
 
-        // Keep traversing until a leaf node is hit
-        // Add the children if they don't exist yet
-        if (cur->children == nullptr) {
-            addChildrenForNode(cur);
-        }
+void QuadTree::nextGeneration(ThreadPool *pool) {
+    collectGarbage();
 
-        // Pick the appropriate child depending on range
-        cur = getChildFromPoint(x, y, cur);
+    // Cells spread a cell a generation, so the pattern needs to sit well
+    // inside the middle half that the result covers, and the root needs
+    // to be big enough to step the whole way
+    uint exponent = stepExponent();
+    while (this->level < MIN_LEVEL || this->level < exponent + 2 || !this->isCentred()) {
+        this->expand();
     }
-}
-
-void QuadTree::addPixel(bool *board, lint boardX, lint boardY) {
-    for (uint x = 0; x < boardX; ++x) {
-        for (uint y = 0; y < boardY; ++y) {
-            if (board[x + (y * boardY)]) {
-                this->addPixel(x, y);
-            }
-        }
+    this->expand();
+
+    GenData *next;
+    if (pool == nullptr || pool->size() == 1) {
+        // Nothing else makes blocks meanwhile
+        setMemoLocking(false);
+        next = result(this->root, this->level, nullptr);
+        setMemoLocking(true);
+    } else {
+        // Forks only reach the other threads from within a batch
+        GenData *root = this->root;
+        uint level = this->level;
+        pool->run(1, [&next, root, level, pool](uint) {
+            next = result(root, level, pool);
+        });
     }
+
+    lint quarter = (lint) 1 << (this->level - 2);
+    this->setRoot(next, this->level - 1, this->originX + quarter, this->originY + quarter);
+    this->generation += (ulint) 1 << exponent;
 }
 
-bool QuadTree::getNextGenPixel(lint x, lint y) {
-    QuadNode *cur = this->root;
-    Range *range;
-    for(;;) {
-        range = &cur->range;
-
-        if (cur->sideLength == 2) {
-            lint borderX = range->startX + (range->endX - range->startX) / 2;
-            lint borderY = range->startY + (range->endY - range->startY) / 2;
-            if (x < borderX && y < borderY)
-                return nw(cur->gd);
-            else if (x >= borderX && y < borderY)
-                return ne(cur->gd);
-            else if (x < borderX && y >= borderY)
-                return sw(cur->gd);
-            else
-                return se(cur->gd);
-
-        } else if (cur->children == nullptr) {
-            // This is only true if we've exhausted our search
-            return false;
+void QuadTree::advance(ulint generations, ThreadPool *pool) {
+    // A step for every bit, each exponent with its own results
+    uint exponent = stepExponent();
+    for (uint bit = 0; (generations >> bit) != 0; ++bit) {
+        if ((generations >> bit) & 1) {
+            setStepExponent(bit);
+            this->nextGeneration(pool);
         }
-        // Pick the appropriate child depending on range
-        cur = getChildFromPoint(x, y, cur);
     }
+    setStepExponent(exponent);
 }
 
-bool QuadTree::getPixel(lint x, lint y) {
-    QuadNode *cur = this->root;
-    for(;;) {
-        if (cur->isLeaf) {
-            // This is only true if we've hit a leaf node
-            return (cur->pixelCount == 1);
-        } else if (cur->children == nullptr) {
-            // This is only true if we've exhausted our search
-            return false;
+void QuadTree::addPixel(lint x, lint y) {
+    // Grow until the cell is inside the root
+    for (;;) {
+        lint side = (lint) 1 << this->level;
+        if (x >= this->originX && x < this->originX + side &&
+            y >= this->originY && y < this->originY + side) {
+            break;
         }
-        // Pick the appropriate child depending on range
-        cur = getChildFromPoint(x, y, cur);
+        this->expand();
     }
+
+    this->root = setCell(this->root, this->level, x - this->originX, y - this->originY);
 }
 
-QuadNode* QuadTree::getChildFromPoint(lint x, lint y, QuadNode *node) {
-    Range *range = &node->range;
-    // Check out of bounds of node
-    if (x < range->startX || x >= range->endX || y < range->startY || y >= range->endY) {
-        return nullptr;
+// Block of the given level with the cells of board from x, y
+static GenData *boardData(bool *board, lint boardX, lint boardY, lint x, lint y, uint level) {
+    if (x >= boardX || y >= boardY) {
+        return setupNullData();
     }
 
-    // Keep adding nodes so long as there are pixels
-    lint borderX = range->startX + (range->endX - range->startX) / 2;
-    lint borderY = range->startY + (range->endY - range->startY) / 2;
-
-    if (x < borderX && y < borderY) {
-        return node->children;
-    }
-    else if (x < borderX && y >= borderY) {
-        return (node->children + 1);
-    }
-    else if (x >= borderX && y < borderY) {
-        return (node->children + 2);
+    if (level == LEAF_LEVEL) {
+        uint64_t cells = 0;
+        for (lint cy = y; cy < std::min(y + (lint) LEAF_SIZE, boardY); ++cy) {
+            for (lint cx = x; cx < std::min(x + (lint) LEAF_SIZE, boardX); ++cx) {
+                if (board[cx + (cy * boardX)]) {
+                    cells |= (uint64_t) 1 << ((cy - y) * LEAF_SIZE + (cx - x));
+                }
+            }
+        }
+        return getLeaf(cells);
     }
 
-    return (node->children + 3);
+    lint half = (lint) 1 << (level - 1);
+    return join(
+        boardData(board, boardX, boardY, x, y, level - 1),
+        boardData(board, boardX, boardY, x + half, y, level - 1),
+        boardData(board, boardX, boardY, x, y + half, level - 1),
+        boardData(board, boardX, boardY, x + half, y + half, level - 1)
+    );
 }
 
-void QuadTree::addChildrenForNode(QuadNode *node) {
-    if (node->children != nullptr) {
+void QuadTree::addPixel(bool *board, lint boardX, lint boardY) {
+    // Built bottom up on an empty tree, so only blocks that end up in
+    // the tree are made
+    if (this->root == this->nullData) {
+        uint level = MIN_LEVEL;
+        while (((lint) 1 << level) < std::max(boardX, boardY)) {
+            ++level;
+        }
+        this->setRoot(boardData(board, boardX, boardY, 0, 0, level), level, 0, 0);
         return;
     }
 
-    Range *range = &node->range;
-    // Keep adding nodes so long as there are pixels
-    lint halfX = (range->endX - range->startX) / 2;
-    lint halfY = (range->endY - range->startY) / 2;
-
-    node->children = new QuadNode[4];
-    QuadNode *newNode;
-    // Add new children with new ranges
-    for (uint i = 0; i < 4; ++i) {
-        newNode = (node->children + i);
-        newNode->id = (this->uidCounter)++;
-        // Set atleast one but not zero so that next loop can check
-        newNode->pixelCount = 1;
-        newNode->parent = node;
-        newNode->children = nullptr;
-        newNode->gd = nullptr;
-        newNode->isLeaf = false;
-
-        Range r;
-        // round down
-        // Notice the order
-        switch(i) {
-            case 0: {
-                r.startX = range->startX;
-                r.startY = range->startY;
-                r.endY = halfY + range->startY;
-                r.endX = halfX + range->startX;
-                break;
-            }
-            case 1: {
-                r.startX = range->startX;
-                r.startY = halfY + range->startY;
-                r.endY = range->endY;
-                r.endX = halfX + range->startX;
-                break;
-            }
-            case 2: {
-                r.startX = halfX + range->startX;
-                r.startY = range->startY;
-                r.endY = halfY + range->startY;
-                r.endX = range->endX;
-                break;
-            }
-            default: {
-                r.startX = halfX + range->startX;
-                r.startY = halfY + range->startY;
-                r.endY = range->endY;
-                r.endX = range->endX;
-                break;
+    for (uint x = 0; x < boardX; ++x) {
+        for (uint y = 0; y < boardY; ++y) {
+            if (board[x + (y * boardX)]) {
+                this->addPixel(x, y);
             }
         }
-
-        // Constrain end points
-        // Always have the range be of difference one if halfX is already one
-        // This only occurs at end points. This allows for consistent range
-        // such that r = [a, b) where a < b and b - a = 1
-        // and leaf nodes to exist
-        if (halfX < 1) {
-            r.endX = 1 - r.startX;
-        }
-
-        if (halfY < 1) {
-            r.endY = 1 - r.startY;
-        }
-
-        if (r.endX - r.startX == 1 && r.endY - r.startY == 1) {
-            newNode->isLeaf = true;
-        }
-
-        newNode->range = r;
-        newNode->sideLength = r.endX - r.startX;
     }
 }
 
-void QuadTree::removeNode(QuadNode *node) {
-    std::vector<QuadNode*> nodes;
-    nodes.push_back(node);
-
-    QuadNode *cur;
-    while (!nodes.empty()) {
-        cur = nodes.back();
-        nodes.pop_back();
+bool QuadTree::getPixel(lint x, lint y) {
+    x -= this->originX;
+    y -= this->originY;
+    lint side = (lint) 1 << this->level;
+    if (x < 0 || y < 0 || x >= side || y >= side) {
+        return false;
+    }
 
-        if (cur->children != nullptr) {
-            for (uint i = 0; i < 4; ++i) {
-                nodes.push_back(&cur->children[i]);
-            }
+    GenData *cur = this->root;
+    for (uint level = this->level; level > LEAF_LEVEL; --level) {
+        // Dead all the way down
+        if (cur == this->nullData) {
+            return false;
         }
 
-        delete cur;
+        lint half = (lint) 1 << (level - 1);
+        if (y < half) {
+            cur = (x < half) ? cur->nw : cur->ne;
+        } else {
+            cur = (x < half) ? cur->sw : cur->se;
+            y -= half;
+        }
+        x -= (x < half) ? 0 : half;
     }
+    return (cur->cells >> (y * LEAF_SIZE + x)) & 1;
 }
-
-void QuadTree::printNode(QuadNode *node) {
-    printf("Start X: %lld \n", node->range.startX);
-    printf("End X: %lld \n", node->range.endX);
-    printf("Start Y: %lld \n", node->range.startY);
-    printf("End Y: %lld \n", node->range.endY);
-    printf("IS LEAF: %d \n", node->isLeaf);
-}
\ No newline at end of file
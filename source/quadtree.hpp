@@ -9,63 +9,58 @@
 #define QUADTREE_HPP
 
 struct GenData;
+class ThreadPool;
 
 typedef long long int lint;
 typedef unsigned long long int ulint;
 typedef unsigned int uint;
 
-struct Range {
-    lint startX; // Inclusive
-    lint startY; // Inclusive
-    lint endX; // Exclusive
-    lint endY; // Exlcusive
-};
-
-struct QuadNode {
-    bool isLeaf;
-    // Length of one side of the square
-    uint id;
-    uint pixelCount;
-    lint sideLength;
-    Range range;
-    QuadNode *parent;
-    QuadNode *children;
-    GenData *gd;
-};
-
+// Unbounded plane of cells held as one shared block (see GenData) of
+// 2^level cells a side. Blocks are immutable, so setting a cell builds
+// new blocks along its path and shares the rest. The root grows as cells
+// are added further out and as the pattern spreads.
 class QuadTree {
-    // Unique id for atleast 4 billion nodes
-    ulint uidCounter;
-    // std::unordered_map<string, QuadNode*> hashlife;
-
     public:
-        // Defined max bounds as given by MAX_TREE_BOUND and MIN_TREE_BOUND
-        Range bounds;
-        QuadNode *root;
+        // Top left cell of the root
+        lint originX;
+        lint originY;
+        uint level;
+        GenData *root;
         GenData *nullData;
+        // Generations stepped so far
+        ulint generation;
 
+        // The root is kept by collectGarbage for as long as the tree lives
         QuadTree();
         ~QuadTree();
 
-        // QuadNode* getNodeFromRange(lint startX, lint endX, lint startY, lint endY);
-
         void addPixel(lint x, lint y);
         void addPixel(bool *board, lint x, lint y);
 
         bool getPixel(lint x, lint y);
-        bool getNextGenPixel(lint x, lint y);
 
-        void removeNode(QuadNode *node);
+        // Replace the whole plane with root, its top left at x, y
+        void setRoot(GenData *root, uint level, lint x, lint y);
 
-        QuadNode* getChildFromPoint(lint x, lint y, QuadNode *node);
+        // Advance the pattern 2^stepExponent() generations of the rule
+        // given to setLifeRule, a two state B/S rule that stays the same
+        // for as long as any block has a result. Results are
+        // kept on the blocks, so parts of the pattern seen before are not
+        // worked out again. Collects garbage first if over the memory
+        // budget. Given a pool, big blocks step their parts across it.
+        void nextGeneration(ThreadPool *pool = nullptr);
 
-        void addChildrenForNode(QuadNode *node);
+        // Advance the pattern any number of generations, a power of two
+        // at a time. Leaves stepExponent() as it was.
+        void advance(ulint generations, ThreadPool *pool = nullptr);
 
-        void printNode(QuadNode *node);
+    private:
+        // Double the root around its centre
+        void expand();
 
-        GenData *nextGeneration(QuadNode *node);
+        // True if every live cell is in the middle half of the root
+        bool isCentred();
 
-    private:
         // Disallow copy constructor
         QuadTree(const QuadTree&) = delete;
 };
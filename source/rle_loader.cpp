@@ -8,27 +8,45 @@
 
 #include "rle_loader.hpp"
 #include "quadtree.hpp"
+#include "bitboard.hpp"
+#include "sparse.hpp"
+#include "chunked.hpp"
+#include "morton.hpp"
+#include "fileboard.hpp"
 
+#include <algorithm>
 #include <iostream>
 #include <fstream>
+#include <memory>
 #include <sstream>
 #include <string>
 
 // Change this to point to a different folder relative to binary execution
 const std::string RLE_FOLDER = "rle";
 
-void loadRLE(std::string filename, bool *board, uint board_x, uint board_y, uint offset_x, uint offset_y) {
+bool parseRLE(
+    std::string filename, uint &size_x, uint &size_y,
+    const std::function<void(uint x, uint y)> &alive
+) {
     // TODO: File integrity should be checked by summing rows
-    std::ifstream rleFile(RLE_FOLDER + "/" + filename);
+    std::ifstream rleFile;
+    if (filename.empty() || filename[0] != '/') {
+        rleFile.open(RLE_FOLDER + "/" + filename);
+    }
+    if (!rleFile.is_open()) {
+        rleFile.open(filename);
+    }
+    if (!rleFile.is_open()) {
+        std::cout << "Cannot open RLE file: " << filename << std::endl;
+        return false;
+    }
 
     // A few flag checking
     bool loadedMeta = false;
     bool set_size_x = false;
     bool set_size_y = false;
-
-    // Size of loaded file
-    uint size_x = board_x + 1;
-    uint size_y = board_y + 1;
+    size_x = 0;
+    size_y = 0;
 
     // Needed variables used for reading compressed lines
     std::string buf = "";
@@ -36,6 +54,14 @@ void loadRLE(std::string filename, bool *board, uint board_x, uint board_y, uint
     uint write_y = 0;
     bool finished = false;
 
+    // Preceeding integers are a run length, default one as defined in
+    // standard
+    auto runLength = [&buf]() -> uint {
+        uint value = (buf == "") ? 1 : std::stoi(buf);
+        buf = "";
+        return value;
+    };
+
     std::string line;
     while(std::getline(rleFile, line) && !finished) {
         // Skip any and all comments
@@ -68,9 +94,7 @@ void loadRLE(std::string filename, bool *board, uint board_x, uint board_y, uint
             // Verify if able to continue with proper size
             if (!set_size_x || !set_size_y) {
                 std::cout << "Invalid file given, no size found. Cannot load: " << filename << std::endl;
-            } else if (size_x > board_x || size_y > board_y) {
-                std::cout << "Given model is larger than allocated memory. Cannot load: " << filename << std::endl;
-                std::cout << "Required Size: " << size_x << ", " << size_y << std::endl;
+                return false;
             }
 
             loadedMeta = true;
@@ -85,42 +109,26 @@ void loadRLE(std::string filename, bool *board, uint board_x, uint board_y, uint
                     break;
                 case '$':
                     // Assume dead cells if any number before eol
-                    // with out a tag. Reset x write head and increment y.
-                    buf = "";
+                    // with out a tag. Reset x write head and move down
+                    // a row for each end of line.
                     write_x = 0;
-                    write_y += 1;
+                    write_y += runLength();
                     break;
                 case ' ':
+                case '\r':
                     break;
-                case 'b': {
-                    // Preceeding integers are for deadcells
-                    uint value;
-                    if (buf == "") {
-                        value = 1; // Default one as defined in standard
-                    } else {
-                        value = std::stoi(buf);
-                    }
-
-                    write_x += value;
-                    buf = "";
+                case 'b':
+                    // Deadcells
+                    write_x += runLength();
                     break;
-                }
                 case 'o': {
-                    // Preceeding integers are for livecells
-                    uint value;
-                    if (buf == "") {
-                        value = 1; // Default one as defined in standard
-                    } else {
-                        value = std::stoi(buf);
-                    }
-
                     // Write all the alive cells
+                    uint value = runLength();
                     for (uint x = write_x; x < write_x + value; ++x) {
-                        board[x + (write_y * board_x)] = true;
+                        alive(x, write_y);
                     }
 
                     write_x += value;
-                    buf = "";
                     break;
                 }
                 default:
@@ -128,123 +136,126 @@ void loadRLE(std::string filename, bool *board, uint board_x, uint board_y, uint
                     buf += c;
                     break;
             }
+
+            if (finished) {
+                break;
+            }
         }
     }
-}
-
-void loadRLE(std::string filename, QuadTree *qtree) {
-       // TODO: File integrity should be checked by summing rows
-    std::ifstream rleFile(RLE_FOLDER + "/" + filename);
 
-    // A few flag checking
-    bool loadedMeta = false;
-    bool set_size_x = false;
-    bool set_size_y = false;
+    return loadedMeta;
+}
 
-    // Size of loaded file
-    uint size_x = 0;
-    uint size_y = 0;
+bool loadRLE(std::string filename, BitBoard *board, uint offset_x, uint offset_y) {
+    uint size_x, size_y;
+    bool loaded = parseRLE(filename, size_x, size_y, [board, offset_x, offset_y](uint x, uint y) {
+        x += offset_x;
+        y += offset_y;
+        if (x < board->width && y < board->height) {
+            board->set(x, y);
+        }
+    });
 
-    // Needed variables used for reading compressed lines
-    std::string buf = "";
-    uint write_x = 0;
-    uint write_y = 0;
-    bool finished = false;
-    bool *board;
+    if (loaded && (size_x + offset_x > board->width || size_y + offset_y > board->height)) {
+        std::cout << "Given model is larger than allocated memory. Only part loaded: " << filename << std::endl;
+        std::cout << "Required Size: " << size_x << ", " << size_y << std::endl;
+    }
+    return loaded;
+}
 
-    std::string line;
-    while(std::getline(rleFile, line) && !finished) {
-        // Skip any and all comments
-        if (line[0] == '#') {
-            continue;
+bool loadRLE(std::string filename, SparseBoard *board, uint offset_x, uint offset_y) {
+    uint size_x, size_y;
+    bool loaded = parseRLE(filename, size_x, size_y, [board, offset_x, offset_y](uint x, uint y) {
+        x += offset_x;
+        y += offset_y;
+        if (x < board->width && y < board->height) {
+            board->set(x, y);
         }
+    });
 
-        // Load metadata to check board size
-        if (!loadedMeta) {
-            std::string token;
-            std::stringstream split(line);
-            while(std::getline(split, token, ',')) {
-                // Strip any starting spaces
-                if (token[0] == ' ') {
-                    token.erase(0, 1);
-                }
+    if (loaded && (size_x + offset_x > board->width || size_y + offset_y > board->height)) {
+        std::cout << "Given model is larger than the board. Only part loaded: " << filename << std::endl;
+        std::cout << "Required Size: " << size_x << ", " << size_y << std::endl;
+    }
+    return loaded;
+}
 
-                // Format will always v = <num>
-                if (token[0] == 'x') {
-                    size_x = std::stoi(token.substr(4)) + 10;
-                    set_size_x = true;
-                } else if (token[0] == 'y') {
-                    size_y = std::stoi(token.substr(4)) + 10;
-                    set_size_y = true;
-                } else {
-                    std::cout << "Ignoring metadata: " << token << std::endl;
-                }
-            }
+bool loadRLE(std::string filename, MortonBoard *board, uint offset_x, uint offset_y) {
+    uint size_x, size_y;
+    bool loaded = parseRLE(filename, size_x, size_y, [board, offset_x, offset_y](uint x, uint y) {
+        x += offset_x;
+        y += offset_y;
+        if (x < board->width && y < board->height) {
+            board->set(x, y);
+        }
+    });
 
-            // Verify if able to continue with proper size
-            if (!set_size_x || !set_size_y) {
-                std::cout << "Invalid file given, no size found. Cannot load: " << filename << std::endl;
-            }
+    if (loaded && (size_x + offset_x > board->width || size_y + offset_y > board->height)) {
+        std::cout << "Given model is larger than the board. Only part loaded: " << filename << std::endl;
+        std::cout << "Required Size: " << size_x << ", " << size_y << std::endl;
+    }
+    return loaded;
+}
 
-            loadedMeta = true;
-            board = new bool[size_x * size_y]();
-            continue;
+// Cells come in row order, so every row of the file is written once
+bool loadRLE(std::string filename, FileBoard *board, uint offset_x, uint offset_y) {
+    uint size_x, size_y;
+    bool loaded = parseRLE(filename, size_x, size_y, [board, offset_x, offset_y](uint x, uint y) {
+        x += offset_x;
+        y += offset_y;
+        if (x < board->width && y < board->height) {
+            board->set(x, y);
         }
+    });
+    board->flush();
 
-        // Load the compressed data
-        for (char &c : line) {
-            switch(c) {
-                case '!':
-                    finished = true;
-                    break;
-                case '$':
-                    // Assume dead cells if any number before eol
-                    // with out a tag. Reset x write head and increment y.
-                    buf = "";
-                    write_x = 0;
-                    write_y += 1;
-                    break;
-                case ' ':
-                    break;
-                case 'b': {
-                    // Preceeding integers are for deadcells
-                    uint value;
-                    if (buf == "") {
-                        value = 1; // Default one as defined in standard
-                    } else {
-                        value = std::stoi(buf);
-                    }
+    if (loaded && (size_x + offset_x > board->width || size_y + offset_y > board->height)) {
+        std::cout << "Given model is larger than the board. Only part loaded: " << filename << std::endl;
+        std::cout << "Required Size: " << size_x << ", " << size_y << std::endl;
+    }
+    return loaded;
+}
 
-                    write_x += value;
-                    buf = "";
-                    break;
-                }
-                case 'o': {
-                    // Preceeding integers are for livecells
-                    uint value;
-                    if (buf == "") {
-                        value = 1; // Default one as defined in standard
-                    } else {
-                        value = std::stoi(buf);
-                    }
+bool loadRLE(std::string filename, ChunkedBoard *board, lint offset_x, lint offset_y) {
+    uint size_x, size_y;
+    return parseRLE(filename, size_x, size_y, [board, offset_x, offset_y](uint x, uint y) {
+        board->set(x + offset_x, y + offset_y);
+    });
+}
 
-                    // Write all the alive cells
-                    for (uint x = write_x; x < write_x + value; ++x) {
-                        board[x + (write_y * size_x)] = true;
-                    }
+// An empty tree is filled from a MortonBoard of the pattern, joined in one
+// pass over its blocks, if the pattern is no bigger than this a side.
+// Bigger patterns, or a tree with cells already, get a cell at a time.
+static const uint MORTON_LOAD_SIDE = 8192;
 
-                    write_x += value;
-                    buf = "";
-                    break;
-                }
-                default:
-                    // Integer
-                    buf += c;
-                    break;
+bool loadRLE(std::string filename, QuadTree *qtree) {
+    uint size_x, size_y;
+    std::unique_ptr<MortonBoard> board;
+    bool picked = false;
+    bool loaded = parseRLE(filename, size_x, size_y, [qtree, &board, &picked, &size_x, &size_y](uint x, uint y) {
+        // The size is known before the first cell
+        if (!picked) {
+            picked = true;
+            if (qtree->root == qtree->nullData && std::max(size_x, size_y) <= MORTON_LOAD_SIDE) {
+                board.reset(new MortonBoard(size_x, size_y));
             }
         }
-    }
 
-    qtree->addPixel(board, size_x, size_y);
-    delete board;
-}
\ No newline at end of file
+        if (board && (x >= board->width || y >= board->height)) {
+            // Past the size the file gave, the rest goes in a cell at a time
+            board->toQuadTree(*qtree);
+            board.reset();
+        }
+
+        if (board) {
+            board->set(x, y);
+        } else {
+            qtree->addPixel(x, y);
+        }
+    });
+
+    if (board) {
+        board->toQuadTree(*qtree);
+    }
+    return loaded;
+}
@@ -8,17 +8,41 @@
 #ifndef RLE_LOADER_HPP
 #define RLE_LOADER_HPP
 
+#include <functional>
 #include <string>
 
+typedef unsigned int uint;
+typedef long long int lint;
+
 class QuadTree;
+class BitBoard;
+class SparseBoard;
+class ChunkedBoard;
+class MortonBoard;
+class FileBoard;
 
 extern const std::string RLE_FOLDER;
 
-// Function to load RLE into an array.
-// RLE file should bin inside folder defined by REL_FOLDER.
-// offset allows an offset to where the file should be loaded in array.
+// Read an RLE file and call alive with every live cell, relative to the
+// top left of the pattern. size_x and size_y are set from the header.
+// A name is looked for inside RLE_FOLDER first, then as a path of its
+// own, so absolute paths and paths from the working directory work too.
+// Returns false if the file cannot be opened or has no size in its header.
 // Currently does not check file integrity
-void loadRLE(std::string filename, bool *board, uint board_x, uint board_y, uint offset_x = 0, uint offset_y = 0);
-void loadRLE(std::string filename, QuadTree *qtree);
+bool parseRLE(
+    std::string filename, uint &size_x, uint &size_y,
+    const std::function<void(uint x, uint y)> &alive
+);
+
+// Function to load RLE into a board.
+// offset allows an offset to where the file should be loaded in board.
+// Cells that do not fit are dropped. Returns false, with nothing loaded,
+// if parseRLE fails.
+bool loadRLE(std::string filename, BitBoard *board, uint offset_x = 0, uint offset_y = 0);
+bool loadRLE(std::string filename, SparseBoard *board, uint offset_x = 0, uint offset_y = 0);
+bool loadRLE(std::string filename, MortonBoard *board, uint offset_x = 0, uint offset_y = 0);
+bool loadRLE(std::string filename, FileBoard *board, uint offset_x = 0, uint offset_y = 0);
+bool loadRLE(std::string filename, ChunkedBoard *board, lint offset_x = 0, lint offset_y = 0);
+bool loadRLE(std::string filename, QuadTree *qtree);
 
 #endif /* RLE_LOADER_HPP */
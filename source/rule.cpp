@@ -0,0 +1,92 @@
+/***********************************************
+ * Project: RaspberryConway
+ * File: rule.cpp
+ * By: ProgrammingIncluded
+ * Website: ProgrammingIncluded.github.io
+ * License: GNU GPLv3 (see LICENSE file)
+***********************************************/
+
+#include "rule.hpp"
+
+#include <cctype>
+
+// Digits 0 to 8 into a count mask, false on anything else
+static bool parseCounts(const std::string &digits, uint &mask) {
+    mask = 0;
+    for (char c : digits) {
+        if (c < '0' || c > '8') {
+            return false;
+        }
+        mask |= 1 << (c - '0');
+    }
+    return true;
+}
+
+bool parseRule(const std::string &text, Rule &rule) {
+    size_t split = text.find('/');
+    if (split == std::string::npos) {
+        return false;
+    }
+
+    std::string first = text.substr(0, split);
+    std::string second = text.substr(split + 1);
+    Rule parsed;
+    parsed.states = 2;
+
+    // Generations rules have a third part with the number of states
+    size_t third = second.find('/');
+    if (third != std::string::npos) {
+        std::string states = second.substr(third + 1);
+        second = second.substr(0, third);
+        if (!states.empty() && std::toupper(states[0]) == 'C') {
+            states = states.substr(1);
+        }
+        if (states.empty() || states.size() > 2 || states.find_first_not_of("0123456789") != std::string::npos) {
+            return false;
+        }
+        parsed.states = std::stoi(states);
+        if (parsed.states < 2 || parsed.states > MAX_STATES) {
+            return false;
+        }
+    }
+
+    // B/S form names each half, S/B form is survive first
+    if (!first.empty() && std::toupper(first[0]) == 'B') {
+        if (second.empty() || std::toupper(second[0]) != 'S') {
+            return false;
+        }
+        if (!parseCounts(first.substr(1), parsed.birth) || !parseCounts(second.substr(1), parsed.survive)) {
+            return false;
+        }
+    } else if (!parseCounts(first, parsed.survive) || !parseCounts(second, parsed.birth)) {
+        return false;
+    }
+
+    if (parsed.birth & 1) {
+        return false;
+    }
+
+    rule = parsed;
+    return true;
+}
+
+std::string ruleString(const Rule &rule) {
+    std::string text = "B";
+    for (uint n = 0; n <= 8; ++n) {
+        if (rule.birth & (1 << n)) {
+            text += (char) ('0' + n);
+        }
+    }
+
+    text += "/S";
+    for (uint n = 0; n <= 8; ++n) {
+        if (rule.survive & (1 << n)) {
+            text += (char) ('0' + n);
+        }
+    }
+
+    if (rule.states > 2) {
+        text += "/C" + std::to_string(rule.states);
+    }
+    return text;
+}
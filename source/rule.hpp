@@ -0,0 +1,65 @@
+/***********************************************
+ * Project: RaspberryConway
+ * File: rule.hpp
+ * By: ProgrammingIncluded
+ * Website: ProgrammingIncluded.github.io
+ * License: GNU GPLv3 (see LICENSE file)
+***********************************************/
+#ifndef RULE_HPP
+#define RULE_HPP
+
+#include <string>
+
+typedef unsigned int uint;
+
+// Most states a Generations rule can have
+static const uint MAX_STATES = 16;
+
+// Life-like rule as two masks over the neighbour count, bit n is set if a
+// dead cell with n live neighbours is born or a live one survives.
+//
+// Generations rules have more than two states. State 0 is dead and 1 is
+// alive, a live cell that does not survive goes to state 2 and counts up
+// each generation until it wraps to dead. Only state 1 counts as a
+// neighbour and only state 0 can be born into.
+struct Rule {
+    uint birth;
+    uint survive;
+    uint states;
+
+    bool operator==(const Rule &r) const {
+        return birth == r.birth && survive == r.survive && states == r.states;
+    }
+};
+
+// Common rules, also used as template arguments for the kernels
+constexpr Rule CONWAY = {1 << 3, 1 << 2 | 1 << 3, 2};
+constexpr Rule HIGHLIFE = {1 << 3 | 1 << 6, 1 << 2 | 1 << 3, 2};
+constexpr Rule DAY_AND_NIGHT = {
+    1 << 3 | 1 << 6 | 1 << 7 | 1 << 8,
+    1 << 3 | 1 << 4 | 1 << 6 | 1 << 7 | 1 << 8,
+    2
+};
+constexpr Rule SEEDS = {1 << 2, 0, 2};
+constexpr Rule BRIANS_BRAIN = {1 << 2, 0, 3};
+constexpr Rule STAR_WARS = {1 << 2, 1 << 3 | 1 << 4 | 1 << 5, 4};
+
+// Boards hold one bit of the state per plane
+inline uint statePlanes(uint states) {
+    uint planes = 1;
+    while ((1u << planes) < states) {
+        planes += 1;
+    }
+    return planes;
+}
+
+// Parse B/S notation such as B36/S23, or the older S/B form 23/36.
+// Generations rules add the number of states, B2/S/C3 or 345/2/4.
+// Rules with B0 are refused since empty space would not stay empty.
+// Returns false and leaves rule alone if the string is not valid.
+bool parseRule(const std::string &text, Rule &rule);
+
+// Rule in B/S notation
+std::string ruleString(const Rule &rule);
+
+#endif /* RULE_HPP */
@@ -0,0 +1,215 @@
+/***********************************************
+ * Project: RaspberryConway
+ * File: settings.cpp
+ * By: ProgrammingIncluded
+ * Website: ProgrammingIncluded.github.io
+ * License: GNU GPLv3 (see LICENSE file)
+***********************************************/
+
+#include "settings.hpp"
+#include "temporal.hpp"
+
+#include <climits>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+
+const Settings DEFAULT_SETTINGS = {
+    0, // threads
+    DENSE, // engine
+    "board.bin", // file
+    2048, // boardWidth
+    2048, // boardHeight
+    DEAD_EDGES, // boundary
+    // Eight words by 128 rows, source and destination fit together in
+    // the 32KB L1 of the Pi 4 Cortex-A72
+    512, // tileWidth
+    128, // tileHeight
+    1, // temporal
+    1, // generations
+    BARRIER, // schedule
+    ROWS, // layout
+    false, // inplace
+    false, // stats
+    0, // rank
+    {}, // peers
+    false, // headless
+    0, // frames
+    256, // memory
+    "", // pattern
+    0, // step
+    CONWAY, // rule
+    {0, MOORE, true, 0, 0, 0, 0}, // ltl
+};
+
+Settings SETTINGS = DEFAULT_SETTINGS;
+
+// Whole number in value, false for anything else, signs included, or a
+// number too big for a uint
+static bool parseUint(const std::string &value, uint &number) {
+    if (value.empty() || value.size() > 10 || value.find_first_not_of("0123456789") != std::string::npos) {
+        return false;
+    }
+
+    unsigned long long parsed = std::stoull(value);
+    if (parsed > UINT_MAX) {
+        return false;
+    }
+    number = parsed;
+    return true;
+}
+
+// Format is <width>x<height>, both above 0
+static bool parseSize(const std::string &value, uint &width, uint &height) {
+    size_t by = value.find('x');
+    if (by == std::string::npos) {
+        return false;
+    }
+
+    uint w, h;
+    if (!parseUint(value.substr(0, by), w) || !parseUint(value.substr(by + 1), h) || w == 0 || h == 0) {
+        return false;
+    }
+    width = w;
+    height = h;
+    return true;
+}
+
+static void usageError(const std::string &arg) {
+    std::cout << "Invalid value: " << arg << std::endl;
+    std::cout << "Options are --name=value, see the Options table in README.md" << std::endl;
+    exit(1);
+}
+
+void parseSettings(int argc, char *argv[]) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        size_t split = arg.find('=');
+        if (arg.compare(0, 2, "--") != 0 || split == std::string::npos) {
+            std::cout << "Ignoring option: " << arg << std::endl;
+            continue;
+        }
+
+        std::string name = arg.substr(2, split - 2);
+        std::string value = arg.substr(split + 1);
+
+        // Numbers and 0 or 1 flags, the run stops on anything else
+        auto number = [&arg, &value](uint &field) {
+            if (!parseUint(value, field)) {
+                usageError(arg);
+            }
+        };
+        auto flag = [&arg, &value](bool &field) {
+            uint on;
+            if (!parseUint(value, on) || on > 1) {
+                usageError(arg);
+            }
+            field = (on == 1);
+        };
+
+        if (name == "threads") {
+            number(SETTINGS.threads);
+        } else if (name == "engine") {
+            if (value == "dense") {
+                SETTINGS.engine = DENSE;
+            } else if (value == "sparse") {
+                SETTINGS.engine = SPARSE;
+            } else if (value == "chunked") {
+                SETTINGS.engine = CHUNKED;
+            } else if (value == "file") {
+                SETTINGS.engine = OUT_OF_CORE;
+            } else {
+                usageError(arg);
+            }
+        } else if (name == "file") {
+            SETTINGS.file = value;
+        } else if (name == "board") {
+            if (!parseSize(value, SETTINGS.boardWidth, SETTINGS.boardHeight)) {
+                usageError(arg);
+            }
+        } else if (name == "boundary") {
+            if (value == "dead") {
+                SETTINGS.boundary = DEAD_EDGES;
+            } else if (value == "torus") {
+                SETTINGS.boundary = TORUS;
+            } else {
+                usageError(arg);
+            }
+        } else if (name == "tile") {
+            if (!parseSize(value, SETTINGS.tileWidth, SETTINGS.tileHeight)) {
+                usageError(arg);
+            }
+        } else if (name == "temporal") {
+            number(SETTINGS.temporal);
+            if (SETTINGS.temporal == 0 || SETTINGS.temporal > MAX_TEMPORAL_STEPS) {
+                usageError(arg);
+            }
+        } else if (name == "generations") {
+            number(SETTINGS.generations);
+        } else if (name == "schedule") {
+            if (value == "barrier") {
+                SETTINGS.schedule = BARRIER;
+            } else if (value == "wavefront") {
+                SETTINGS.schedule = WAVEFRONT;
+            } else {
+                usageError(arg);
+            }
+        } else if (name == "layout") {
+            if (value == "rows") {
+                SETTINGS.layout = ROWS;
+            } else if (value == "morton") {
+                SETTINGS.layout = MORTON;
+            } else {
+                usageError(arg);
+            }
+        } else if (name == "inplace") {
+            flag(SETTINGS.inplace);
+        } else if (name == "rank") {
+            number(SETTINGS.rank);
+        } else if (name == "peers") {
+            // Comma separated, one address per rank
+            SETTINGS.peers.clear();
+            size_t start = 0;
+            for (;;) {
+                size_t comma = value.find(',', start);
+                SETTINGS.peers.push_back(value.substr(start, comma - start));
+                if (comma == std::string::npos) {
+                    break;
+                }
+                start = comma + 1;
+            }
+        } else if (name == "headless") {
+            flag(SETTINGS.headless);
+        } else if (name == "frames") {
+            number(SETTINGS.frames);
+        } else if (name == "memory") {
+            number(SETTINGS.memory);
+        } else if (name == "pattern") {
+            SETTINGS.pattern = value;
+        } else if (name == "step") {
+            number(SETTINGS.step);
+        } else if (name == "stats") {
+            flag(SETTINGS.stats);
+        } else if (name == "rule" && !value.empty() && (value[0] == 'R' || value[0] == 'r')) {
+            // Larger than Life rules start with the radius
+            if (!parseLtlRule(value, SETTINGS.ltl)) {
+                usageError(arg);
+            }
+        } else if (name == "rule") {
+            if (!parseRule(value, SETTINGS.rule)) {
+                usageError(arg);
+            }
+        } else {
+            std::cout << "Ignoring option: " << arg << std::endl;
+        }
+    }
+
+    // Fill in anything left to be picked from the machine
+    if (SETTINGS.threads == 0) {
+        SETTINGS.threads = std::thread::hardware_concurrency();
+    }
+    if (SETTINGS.threads == 0) {
+        SETTINGS.threads = 4;
+    }
+}
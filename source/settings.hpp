@@ -0,0 +1,102 @@
+/***********************************************
+ * Project: RaspberryConway
+ * File: settings.hpp
+ * By: ProgrammingIncluded
+ * Website: ProgrammingIncluded.github.io
+ * License: GNU GPLv3 (see LICENSE file)
+***********************************************/
+#ifndef SETTINGS_HPP
+#define SETTINGS_HPP
+
+#include "bitboard.hpp"
+#include "ltl.hpp"
+#include "rule.hpp"
+
+#include <string>
+#include <vector>
+
+// How tiles of the naive board are scheduled across passes
+enum Schedule {
+    // Every tile finishes a pass before any starts the next
+    BARRIER,
+    // Tiles start the next pass once their neighbours are done
+    WAVEFRONT
+};
+
+// How cells of the dense board are laid out in memory
+enum Layout {
+    // Bit packed rows, see BitBoard
+    ROWS,
+    // 8x8 blocks in Morton order, see MortonBoard
+    MORTON
+};
+
+// What steps the board
+enum Engine {
+    // Bit packed board stepped in tiles
+    DENSE,
+    // Hash set of live cells, for big boards with few cells
+    SPARSE,
+    // Bit packed chunks allocated as cells reach them, no board edges
+    CHUNKED,
+    // Bit packed board in a file, streamed through memory in blocks
+    OUT_OF_CORE
+};
+
+// Runtime settings, given on the command line as --name=value
+struct Settings {
+    // Worker threads, defaults to the number of hardware threads
+    uint threads;
+    Engine engine;
+    // Board file of the out of core engine, the next generation is
+    // written to the same name with .next on the end
+    std::string file;
+    // Board size in cells, never smaller than the screen
+    uint boardWidth;
+    uint boardHeight;
+    // Edges of the naive board, dead or wrapped around
+    Boundary boundary;
+    // Cells per tile of the naive board, width is rounded to whole words
+    uint tileWidth;
+    uint tileHeight;
+    // Generations each tile is advanced per pass, 1 steps the whole
+    // board once per generation
+    uint temporal;
+    // Passes over the board per frame
+    uint generations;
+    Schedule schedule;
+    Layout layout;
+    // Step the dense board in place in stripes of tileHeight rows,
+    // keeping one board instead of two
+    bool inplace;
+    // Print per frame statistics of the engine
+    bool stats;
+    // Rank of this process and the address of every rank when one board
+    // is split across processes (see Cluster), empty otherwise
+    uint rank;
+    std::vector<std::string> peers;
+    // Run without the screen or keyboard
+    bool headless;
+    // Frames to run before exiting, 0 runs until stopped
+    uint frames;
+    // Memory for the blocks of the Hashlife quadtree in MB, 0 for no
+    // limit
+    uint memory;
+    // RLE pattern the Hashlife build starts with, a glider if empty
+    std::string pattern;
+    // Hashlife steps 2^step generations a frame to start with
+    uint step;
+    // Life-like rule in B/S notation
+    Rule rule;
+    // Larger than Life rule, used instead of rule if its radius is set
+    LtlRule ltl;
+};
+
+extern Settings SETTINGS;
+// What SETTINGS holds before the command line is read
+extern const Settings DEFAULT_SETTINGS;
+
+// Fill SETTINGS from the command line, unknown options are ignored
+void parseSettings(int argc, char *argv[]);
+
+#endif /* SETTINGS_HPP */
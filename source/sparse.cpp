@@ -0,0 +1,68 @@
+/***********************************************
+ * Project: RaspberryConway
+ * File: sparse.cpp
+ * By: ProgrammingIncluded
+ * Website: ProgrammingIncluded.github.io
+ * License: GNU GPLv3 (see LICENSE file)
+***********************************************/
+
+#include "sparse.hpp"
+
+SparseBoard::SparseBoard(uint width, uint height, Boundary boundary, const Rule &rule) {
+    this->width = width;
+    this->height = height;
+    this->boundary = boundary;
+    this->rule = rule;
+}
+
+void SparseBoard::step() {
+    this->counts.clear();
+    this->counts.reserve(this->live.size() * 4);
+
+    for (uint64_t cell : this->live) {
+        uint x = (uint) cell;
+        uint y = (uint) (cell >> 32);
+        this->counts[cell] |= 1;
+
+        for (int dy = -1; dy <= 1; ++dy) {
+            for (int dx = -1; dx <= 1; ++dx) {
+                if (dx == 0 && dy == 0) {
+                    continue;
+                }
+
+                // Past a dead edge there is nothing to count into
+                long nx = (long) x + dx;
+                long ny = (long) y + dy;
+                if (this->boundary == TORUS) {
+                    nx = (nx + this->width) % this->width;
+                    ny = (ny + this->height) % this->height;
+                } else if (nx < 0 || ny < 0 || nx >= this->width || ny >= this->height) {
+                    continue;
+                }
+
+                this->counts[key(nx, ny)] += 2;
+            }
+        }
+    }
+
+    // B0 is not allowed, so only cells with a count can be alive next
+    this->live.clear();
+    for (const std::pair<const uint64_t, uint8_t> &count : this->counts) {
+        uint neighbours = count.second >> 1;
+        uint mask = (count.second & 1) ? this->rule.survive : this->rule.birth;
+        if ((mask >> neighbours) & 1) {
+            this->live.insert(count.first);
+        }
+    }
+}
+
+void SparseBoard::render(BitBoard &view, uint x, uint y) const {
+    view.clear();
+    for (uint64_t cell : this->live) {
+        uint cx = (uint) cell;
+        uint cy = (uint) (cell >> 32);
+        if (cx >= x && cy >= y && cx - x < view.width && cy - y < view.height) {
+            view.set(cx - x, cy - y);
+        }
+    }
+}
@@ -0,0 +1,68 @@
+/***********************************************
+ * Project: RaspberryConway
+ * File: sparse.hpp
+ * By: ProgrammingIncluded
+ * Website: ProgrammingIncluded.github.io
+ * License: GNU GPLv3 (see LICENSE file)
+***********************************************/
+#ifndef SPARSE_HPP
+#define SPARSE_HPP
+
+#include "bitboard.hpp"
+#include "rule.hpp"
+
+#include <cstdint>
+#include <unordered_map>
+#include <unordered_set>
+
+// Board that only stores its live cells, in a hash set. Each generation
+// every live cell adds itself to the counts of its neighbours, so the
+// cost follows the population instead of the area and the board can be
+// far larger than a dense one. Two state B/S rules only.
+class SparseBoard {
+    public:
+        uint width;
+        uint height;
+        Boundary boundary;
+        Rule rule;
+
+        SparseBoard(uint width, uint height, Boundary boundary, const Rule &rule);
+
+        inline bool get(uint x, uint y) const {
+            return this->live.count(key(x, y)) != 0;
+        }
+
+        inline void set(uint x, uint y, bool alive = true) {
+            if (alive) {
+                this->live.insert(key(x, y));
+            } else {
+                this->live.erase(key(x, y));
+            }
+        }
+
+        inline size_t population() const {
+            return this->live.size();
+        }
+
+        void step();
+
+        // Draw the cells from (x, y) to (x + view.width, y + view.height)
+        // into view, anything else in view is cleared
+        void render(BitBoard &view, uint x, uint y) const;
+
+    private:
+        // Cell y in the high half and x in the low half
+        std::unordered_set<uint64_t> live;
+        // Twice the neighbour count, plus one if the cell is alive.
+        // Kept between generations so its buckets are reused.
+        std::unordered_map<uint64_t, uint8_t> counts;
+
+        static inline uint64_t key(uint x, uint y) {
+            return ((uint64_t) y << 32) | x;
+        }
+
+        // Disallow copy constructor
+        SparseBoard(const SparseBoard&) = delete;
+};
+
+#endif /* SPARSE_HPP */
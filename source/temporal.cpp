@@ -0,0 +1,144 @@
+/***********************************************
+ * Project: RaspberryConway
+ * File: temporal.cpp
+ * By: ProgrammingIncluded
+ * Website: ProgrammingIncluded.github.io
+ * License: GNU GPLv3 (see LICENSE file)
+***********************************************/
+
+#include "temporal.hpp"
+#include "kernel.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+// Read count (at most 64) cells starting at cell x of a row
+static inline uint64_t readBits(const uint64_t *row, uint x, uint count) {
+    uint word = x >> 6;
+    uint offset = x & 63;
+    uint64_t bits = row[word] >> offset;
+    if (offset != 0 && offset + count > 64) {
+        bits |= row[word + 1] << (64 - offset);
+    }
+    return (count == 64) ? bits : bits & (((uint64_t) 1 << count) - 1);
+}
+
+// 64 cells starting at cell x of a row, wrapping around the row
+static uint64_t wrappedWord(const BitBoard &board, const uint64_t *row, long x) {
+    long width = board.width;
+    x = ((x % width) + width) % width;
+
+    // Aligned and inside the row, the common case
+    if ((x & 63) == 0 && x + 64 <= width) {
+        return row[x >> 6];
+    }
+
+    uint64_t word = 0;
+    uint filled = 0;
+    while (filled < 64) {
+        uint count = std::min<long>(64 - filled, width - x);
+        word |= readBits(row, x, count) << filled;
+        filled += count;
+        x = 0;
+    }
+    return word;
+}
+
+bool stepTileTemporal(
+    const BitBoard &src, BitBoard &dst,
+    const Tile &tile, uint steps, Boundary boundary
+) {
+    // Local area is the tile with steps rows and one word either side
+    long firstWord = (long) tile.startWord - 1;
+    long firstY = (long) tile.startY - steps;
+    uint words = tile.endWord - tile.startWord + 2;
+    uint rows = tile.endY - tile.startY + 2 * steps;
+    // Plus ghost words and rows so the row kernel can run unchanged
+    uint pitch = words + 2;
+    uint size = pitch * (rows + 2);
+
+    // Scratch is kept per thread between calls
+    static thread_local std::vector<uint64_t> front;
+    static thread_local std::vector<uint64_t> back;
+    static thread_local std::vector<uint64_t> columnMask;
+    // Rows off the board stay zero from here. back is always written
+    // before it is read, apart from its ghost words, which only ever
+    // disturb the outer halo cells like any other cell past the halo.
+    front.assign(size, 0);
+    back.resize(size);
+    columnMask.assign(words, 0);
+
+    // Word 0 of local row y
+    auto local = [pitch](std::vector<uint64_t> &buffer, uint y) {
+        return buffer.data() + (y + 1) * pitch + 1;
+    };
+
+    // Gather the tile and its halo
+    for (uint y = 0; y < rows; ++y) {
+        long boardY = firstY + y;
+        uint64_t *gathered = local(front, y);
+
+        if (boundary == TORUS) {
+            boardY = ((boardY % src.height) + src.height) % src.height;
+            const uint64_t *row = src.row(boardY);
+            for (uint i = 0; i < words; ++i) {
+                gathered[i] = wrappedWord(src, row, (firstWord + i) * 64);
+            }
+        } else if (boardY >= 0 && boardY < src.height) {
+            // The halo words are at most the ghost words of src, which
+            // are dead already, so the row can be copied straight over
+            memcpy(gathered, src.row(boardY) + firstWord, sizeof(uint64_t) * words);
+        }
+    }
+
+    // Cells of each local word that lie on the board, for dead edges
+    for (uint i = 0; i < words; ++i) {
+        long boardWord = firstWord + i;
+        if (boardWord >= 0 && boardWord < (long) src.stride) {
+            columnMask[i] = (boardWord + 1 == (long) src.stride) ? src.lastMask : ~(uint64_t) 0;
+        }
+    }
+
+    // Each generation the outermost valid row on each side is lost
+    const LifeKernel &kernel = lifeKernel();
+    for (uint step = 1; step <= steps; ++step) {
+        for (uint y = step; y < rows - step; ++y) {
+            uint64_t *out = local(back, y);
+            kernel.step(local(front, y - 1), local(front, y), local(front, y + 1), out, words);
+
+            // Off the board stays dead, on a torus the halo holds the
+            // wrapped cells and can be left as is. Only the halo words
+            // and the last word of the tile can reach off the board.
+            if (boundary == DEAD_EDGES) {
+                long boardY = firstY + y;
+                if (boardY < 0 || boardY >= src.height) {
+                    memset(out, 0, sizeof(uint64_t) * words);
+                } else {
+                    out[0] &= columnMask[0];
+                    out[words - 2] &= columnMask[words - 2];
+                    out[words - 1] &= columnMask[words - 1];
+                }
+            }
+        }
+        front.swap(back);
+    }
+
+    // Write back the tile, which is now steps generations ahead
+    uint64_t diff = 0;
+    uint tileWords = words - 2;
+    bool lastWord = (tile.endWord == src.stride);
+    for (uint y = tile.startY; y < tile.endY; ++y) {
+        const uint64_t *stepped = local(front, y - firstY) + 1;
+        const uint64_t *old = src.row(y) + tile.startWord;
+        uint64_t *out = dst.row(y) + tile.startWord;
+
+        for (uint i = 0; i < tileWords; ++i) {
+            uint64_t mask = (lastWord && i + 1 == tileWords) ? src.lastMask : ~(uint64_t) 0;
+            out[i] = stepped[i] & mask;
+            diff |= (out[i] ^ old[i]) & mask;
+        }
+    }
+
+    return diff != 0;
+}
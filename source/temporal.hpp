@@ -0,0 +1,29 @@
+/***********************************************
+ * Project: RaspberryConway
+ * File: temporal.hpp
+ * By: ProgrammingIncluded
+ * Website: ProgrammingIncluded.github.io
+ * License: GNU GPLv3 (see LICENSE file)
+***********************************************/
+#ifndef TEMPORAL_HPP
+#define TEMPORAL_HPP
+
+#include "bitboard.hpp"
+#include "tiling.hpp"
+
+// Largest number of generations a tile can be advanced in one pass.
+// Halos are one word wide so this is bounded by the word size.
+static const uint MAX_TEMPORAL_STEPS = 64;
+
+// Advance a tile of src by steps generations and write it into dst.
+// The tile plus a halo of steps cells is copied into a per thread buffer
+// and stepped there, the valid area shrinking by one cell each generation
+// (trapezoid tiling) until only the tile is left. src is only read, so
+// every tile can run in parallel. Gives the same cells as stepping the
+// whole board steps times. Returns true if any cell of the tile changed.
+bool stepTileTemporal(
+    const BitBoard &src, BitBoard &dst,
+    const Tile &tile, uint steps, Boundary boundary
+);
+
+#endif /* TEMPORAL_HPP */
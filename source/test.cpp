@@ -0,0 +1,816 @@
+/***********************************************
+ * Project: RaspberryConway
+ * File: test.cpp
+ * By: ProgrammingIncluded
+ * Website: ProgrammingIncluded.github.io
+ * License: GNU GPLv3 (see LICENSE file)
+***********************************************/
+
+// Checks of every engine against the row major BitBoard stepped one
+// generation at a time with stepRows. Build and run with make test, the
+// exit status is the number of checks that failed.
+
+#include "bitboard.hpp"
+#include "chunked.hpp"
+#include "cluster.hpp"
+#include "fileboard.hpp"
+#include "gendata.hpp"
+#include "inplace.hpp"
+#include "kernel.hpp"
+#include "ltl.hpp"
+#include "morton.hpp"
+#include "quadtree.hpp"
+#include "rule.hpp"
+#include "sparse.hpp"
+#include "temporal.hpp"
+#include "threadpool.hpp"
+#include "tiling.hpp"
+#include "wavefront.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Clear board and bring about percent of its cells to life
+static void fillRandom(BitBoard &board, uint seed, uint percent) {
+    std::mt19937 random(seed);
+    board.clear();
+    for (uint y = 0; y < board.height; ++y) {
+        for (uint x = 0; x < board.width; ++x) {
+            if (random() % 100 < percent) {
+                board.set(x, y);
+            }
+        }
+    }
+}
+
+// Step board generations times with the plain row kernel, next is
+// scratch of the same size
+static void stepReference(BitBoard *&board, BitBoard *&next, Boundary boundary, uint generations) {
+    for (uint g = 0; g < generations; ++g) {
+        board->fillHalo(boundary);
+        stepRows(*board, *next, 0, board->height);
+        std::swap(board, next);
+    }
+}
+
+// Cells of a board whose state differs from get(x, y), the first few
+// printed
+template <class F>
+static uint countDifferences(const BitBoard &board, const F &get) {
+    uint differences = 0;
+    for (uint y = 0; y < board.height; ++y) {
+        for (uint x = 0; x < board.width; ++x) {
+            if (board.state(x, y) != (uint) get(x, y)) {
+                if (differences < 4) {
+                    std::cout << "  differs at " << x << ", " << y << std::endl;
+                }
+                ++differences;
+            }
+        }
+    }
+    return differences;
+}
+
+static bool checkMorton() {
+    bool passed = true;
+    for (Boundary boundary : {DEAD_EDGES, TORUS}) {
+        const uint width = 200;
+        const uint height = 136;
+        BitBoard *board = new BitBoard(width, height);
+        BitBoard *next = new BitBoard(width, height);
+        fillRandom(*board, 16, 35);
+
+        MortonBoard *morton = new MortonBoard(width, height);
+        MortonBoard *mortonNext = new MortonBoard(width, height);
+        for (uint y = 0; y < height; ++y) {
+            for (uint x = 0; x < width; ++x) {
+                morton->set(x, y, board->get(x, y));
+            }
+        }
+
+        for (uint g = 0; g < 50; ++g) {
+            stepMorton(*morton, *mortonNext, 0, morton->size(), boundary);
+            std::swap(morton, mortonNext);
+        }
+        stepReference(board, next, boundary, 50);
+
+        uint differences = countDifferences(*board, [morton](uint x, uint y) {
+            return morton->get(x, y);
+        });
+
+        // The single pass conversion gives the same cells as the board
+        QuadTree tree;
+        morton->toQuadTree(tree);
+        differences += countDifferences(*board, [&tree](uint x, uint y) {
+            return tree.getPixel(x, y);
+        });
+        for (lint y = -8; y < (lint) height + 8; ++y) {
+            differences += tree.getPixel(-1, y) + tree.getPixel(width, y);
+        }
+
+        if (differences != 0) {
+            std::cout << "  " << differences << " cells differ, boundary " << boundary << std::endl;
+            passed = false;
+        }
+
+        delete board;
+        delete next;
+        delete morton;
+        delete mortonNext;
+    }
+    return passed;
+}
+
+static bool checkInPlace() {
+    bool passed = true;
+    for (const char *text : {"B3/S23", "B2/S/C3"}) {
+        Rule rule;
+        parseRule(text, rule);
+        setLifeRule(rule);
+
+        for (Boundary boundary : {DEAD_EDGES, TORUS}) {
+            // Stripes of 16 rows, the last one short
+            const uint width = 192;
+            const uint height = 150;
+            uint planes = statePlanes(rule.states);
+            BitBoard *board = new BitBoard(width, height, planes);
+            BitBoard *next = new BitBoard(width, height, planes);
+            BitBoard inplace(width, height, planes);
+            fillRandom(*board, 17, 35);
+            for (uint y = 0; y < height; ++y) {
+                for (uint x = 0; x < width; ++x) {
+                    inplace.setState(x, y, board->state(x, y));
+                }
+            }
+
+            TileGrid stripes(inplace, width, 16);
+            StripeEdges edges(inplace, stripes);
+            for (uint g = 0; g < 50; ++g) {
+                inplace.fillHalo(boundary);
+                stripes.markActive(boundary);
+                edges.save(inplace, stripes);
+                for (uint s : stripes.active) {
+                    stripes.changed[s] = stepStripeInPlace(inplace, stripes.tiles[s], s, edges);
+                }
+            }
+            stepReference(board, next, boundary, 50);
+
+            uint differences = countDifferences(*board, [&inplace](uint x, uint y) {
+                return inplace.state(x, y);
+            });
+            if (differences != 0) {
+                std::cout << "  " << differences << " cells differ, " << text << " boundary " << boundary << std::endl;
+                passed = false;
+            }
+
+            delete board;
+            delete next;
+        }
+    }
+    return passed;
+}
+
+static bool checkTemporal() {
+    bool passed = true;
+    // Generations rules are refused by temporal blocking, so two B/S rules
+    for (const char *text : {"B3/S23", "B36/S23"}) {
+        Rule rule;
+        parseRule(text, rule);
+        setLifeRule(rule);
+
+        for (Boundary boundary : {DEAD_EDGES, TORUS}) {
+            for (uint steps : {2u, 5u, 16u, 64u}) {
+                // Tiles of one and three words, odd heights, and the last
+                // word of each row short
+                for (uint tileWidth : {64u, 192u}) {
+                    const uint width = 200;
+                    const uint height = 150;
+                    const uint tileHeight = (tileWidth == 64) ? 13 : 37;
+                    BitBoard *board = new BitBoard(width, height);
+                    BitBoard *next = new BitBoard(width, height);
+                    BitBoard *temporal = new BitBoard(width, height);
+                    BitBoard *buffer = new BitBoard(width, height);
+                    fillRandom(*board, 20, 35);
+                    for (uint y = 0; y < height; ++y) {
+                        for (uint x = 0; x < width; ++x) {
+                            temporal->set(x, y, board->get(x, y));
+                        }
+                    }
+
+                    TileGrid grid(*temporal, tileWidth, tileHeight);
+                    for (uint pass = 0; pass < 2; ++pass) {
+                        temporal->fillHalo(boundary);
+                        for (const Tile &tile : grid.tiles) {
+                            stepTileTemporal(*temporal, *buffer, tile, steps, boundary);
+                        }
+                        std::swap(temporal, buffer);
+                    }
+                    stepReference(board, next, boundary, 2 * steps);
+
+                    uint differences = countDifferences(*board, [temporal](uint x, uint y) {
+                        return temporal->get(x, y);
+                    });
+                    if (differences != 0) {
+                        std::cout << "  " << differences << " cells differ, " << text << " boundary " << boundary
+                                  << " steps " << steps << " tile " << tileWidth << "x" << tileHeight << std::endl;
+                        passed = false;
+                    }
+
+                    delete board;
+                    delete next;
+                    delete temporal;
+                    delete buffer;
+                }
+            }
+        }
+    }
+    return passed;
+}
+
+static bool checkWavefront() {
+    bool passed = true;
+    ThreadPool pool(3);
+    for (const char *text : {"B3/S23", "B2/S/C3"}) {
+        Rule rule;
+        parseRule(text, rule);
+        setLifeRule(rule);
+        uint planes = statePlanes(rule.states);
+
+        for (Boundary boundary : {DEAD_EDGES, TORUS}) {
+            // Temporal blocking only takes two states
+            for (uint steps : {1u, 3u}) {
+                if (planes > 1 && steps > 1) {
+                    continue;
+                }
+
+                // Sparse enough that parts settle and their tiles are
+                // skipped. Whole words a row as in main, so tiles fill torus
+                // ghost cells without touching each other's words.
+                const uint width = 256;
+                const uint height = 150;
+                BitBoard *board = new BitBoard(width, height, planes);
+                BitBoard *next = new BitBoard(width, height, planes);
+                BitBoard *front = new BitBoard(width, height, planes);
+                BitBoard *back = new BitBoard(width, height, planes);
+                fillRandom(*board, 21, 8);
+                for (uint y = 0; y < height; ++y) {
+                    for (uint x = 0; x < width; ++x) {
+                        front->setState(x, y, board->state(x, y));
+                    }
+                }
+
+                TileGrid grid(*front, 64, 16);
+                Wavefront wavefront(grid, boundary, grid.reach(steps));
+                auto step = [&](uint t, uint pass) {
+                    BitBoard *src = (pass % 2 == 0) ? front : back;
+                    BitBoard *dst = (pass % 2 == 0) ? back : front;
+                    const Tile &tile = grid.tiles[t];
+                    bool changed = (steps > 1)
+                        ? stepTileTemporal(*src, *dst, tile, steps, boundary)
+                        : stepTile(*src, *dst, tile.startWord, tile.endWord, tile.startY, tile.endY);
+                    dst->fillHalo(boundary, tile.startWord, tile.endWord, tile.startY, tile.endY);
+                    return changed;
+                };
+
+                // Runs of an odd and an even number of passes, the board
+                // swapped between them as the front end does
+                uint generations = 0;
+                for (uint passes : {15u, 16u}) {
+                    front->fillHalo(boundary);
+                    wavefront.run(pool, passes, step);
+                    if (passes % 2 == 1) {
+                        std::swap(front, back);
+                    }
+                    generations += passes * steps;
+                }
+                stepReference(board, next, boundary, generations);
+
+                uint differences = countDifferences(*board, [front](uint x, uint y) {
+                    return front->state(x, y);
+                });
+                if (differences != 0) {
+                    std::cout << "  " << differences << " cells differ, " << text << " boundary " << boundary
+                              << " steps " << steps << std::endl;
+                    passed = false;
+                }
+
+                delete board;
+                delete next;
+                delete front;
+                delete back;
+            }
+        }
+    }
+    return passed;
+}
+
+// One generation of a Larger than Life rule, counting every cell of the
+// neighbourhood one at a time
+static void stepLtlReference(const BitBoard &board, BitBoard &next, const LtlRule &rule, Boundary boundary) {
+    long r = rule.radius;
+    long width = board.width;
+    long height = board.height;
+    for (long y = 0; y < height; ++y) {
+        for (long x = 0; x < width; ++x) {
+            uint count = 0;
+            for (long dy = -r; dy <= r; ++dy) {
+                for (long dx = -r; dx <= r; ++dx) {
+                    bool inside = (rule.neighbourhood == MOORE) || (std::abs(dx) + std::abs(dy) <= r);
+                    if (!inside || (dx == 0 && dy == 0 && !rule.middle)) {
+                        continue;
+                    }
+                    long nx = x + dx;
+                    long ny = y + dy;
+                    if (boundary == TORUS) {
+                        nx = (nx + width) % width;
+                        ny = (ny + height) % height;
+                    } else if (nx < 0 || nx >= width || ny < 0 || ny >= height) {
+                        continue;
+                    }
+                    count += board.get(nx, ny);
+                }
+            }
+
+            bool alive = board.get(x, y)
+                ? (count >= rule.surviveMin && count <= rule.surviveMax)
+                : (count >= rule.birthMin && count <= rule.birthMax);
+            next.set(x, y, alive);
+        }
+    }
+}
+
+static bool checkLtl() {
+    bool passed = true;
+    const char *rules[] = {
+        "R5,C0,M1,S34..58,B34..45,NM",
+        "R3,C0,M0,S8..20,B11..16,NM",
+        "R4,C0,M1,S10..20,B10..16,NN",
+        "R2,C0,M0,S3..6,B4..5,NN",
+    };
+    for (const char *text : rules) {
+        LtlRule rule;
+        if (!parseLtlRule(text, rule)) {
+            std::cout << "  " << text << " does not parse" << std::endl;
+            passed = false;
+            continue;
+        }
+
+        for (Boundary boundary : {DEAD_EDGES, TORUS}) {
+            // Tiles a word wide and 13 rows high, so the neighbourhood
+            // reaches into the tiles around, and the last word short
+            const uint width = 200;
+            const uint height = 150;
+            BitBoard *board = new BitBoard(width, height);
+            BitBoard *next = new BitBoard(width, height);
+            BitBoard *ltl = new BitBoard(width, height);
+            BitBoard *buffer = new BitBoard(width, height);
+            fillRandom(*board, 22, 45);
+            for (uint y = 0; y < height; ++y) {
+                for (uint x = 0; x < width; ++x) {
+                    ltl->set(x, y, board->get(x, y));
+                }
+            }
+
+            TileGrid grid(*ltl, 64, 13);
+            for (uint g = 0; g < 10; ++g) {
+                for (const Tile &tile : grid.tiles) {
+                    stepTileLtl(*ltl, *buffer, tile, rule, boundary);
+                }
+                std::swap(ltl, buffer);
+                stepLtlReference(*board, *next, rule, boundary);
+                std::swap(board, next);
+            }
+
+            uint differences = countDifferences(*board, [ltl](uint x, uint y) {
+                return ltl->get(x, y);
+            });
+            if (differences != 0) {
+                std::cout << "  " << differences << " cells differ, " << text << " boundary " << boundary << std::endl;
+                passed = false;
+            }
+
+            delete board;
+            delete next;
+            delete ltl;
+            delete buffer;
+        }
+    }
+    return passed;
+}
+
+static bool checkSparse() {
+    bool passed = true;
+    // Two state rules only
+    for (const char *text : {"B3/S23", "B36/S23"}) {
+        Rule rule;
+        parseRule(text, rule);
+        setLifeRule(rule);
+
+        for (Boundary boundary : {DEAD_EDGES, TORUS}) {
+            const uint width = 200;
+            const uint height = 150;
+            BitBoard *board = new BitBoard(width, height);
+            BitBoard *next = new BitBoard(width, height);
+            fillRandom(*board, 23, 35);
+
+            SparseBoard sparse(width, height, boundary, rule);
+            for (uint y = 0; y < height; ++y) {
+                for (uint x = 0; x < width; ++x) {
+                    sparse.set(x, y, board->get(x, y));
+                }
+            }
+
+            for (uint g = 0; g < 50; ++g) {
+                sparse.step();
+            }
+            stepReference(board, next, boundary, 50);
+
+            BitBoard view(width, height);
+            sparse.render(view, 0, 0);
+            uint differences = countDifferences(*board, [&view](uint x, uint y) {
+                return view.get(x, y);
+            });
+
+            // A window part way in, running off the board, shows the
+            // same cells and nothing past the edge
+            BitBoard window(100, 100);
+            sparse.render(window, 150, 90);
+            for (uint y = 0; y < window.height; ++y) {
+                for (uint x = 0; x < window.width; ++x) {
+                    bool inside = (150 + x < width && 90 + y < height);
+                    differences += window.get(x, y) != (inside && board->get(150 + x, 90 + y));
+                }
+            }
+
+            if (differences != 0) {
+                std::cout << "  " << differences << " cells differ, " << text << " boundary " << boundary << std::endl;
+                passed = false;
+            }
+
+            delete board;
+            delete next;
+        }
+    }
+    return passed;
+}
+
+static bool checkChunked() {
+    bool passed = true;
+    ThreadPool pool(3);
+    // Two state rules only
+    for (const char *text : {"B3/S23", "B36/S23"}) {
+        Rule rule;
+        parseRule(text, rule);
+        setLifeRule(rule);
+
+        // The plane has no edges, so the board is big enough that the
+        // pattern never reaches them. The pattern straddles the origin of
+        // the plane so chunks at negative positions are stepped too.
+        const uint generations = 60;
+        const uint margin = generations + 8;
+        const uint size = 100;
+        const uint side = size + 2 * margin;
+        const lint first = -37;
+        BitBoard *board = new BitBoard(side, side);
+        BitBoard *next = new BitBoard(side, side);
+        BitBoard pattern(size, size);
+        fillRandom(pattern, 25, 35);
+
+        ChunkedBoard chunked;
+        for (uint y = 0; y < size; ++y) {
+            for (uint x = 0; x < size; ++x) {
+                if (pattern.get(x, y)) {
+                    board->set(margin + x, margin + y);
+                    chunked.set(first + x, first + y);
+                }
+            }
+        }
+
+        for (uint g = 0; g < generations; ++g) {
+            chunked.step(pool);
+        }
+        stepReference(board, next, DEAD_EDGES, generations);
+
+        lint offset = first - (lint) margin;
+        uint differences = countDifferences(*board, [&chunked, offset](uint x, uint y) {
+            return chunked.get(x + offset, y + offset);
+        });
+        ulint population = 0;
+        for (uint y = 0; y < side; ++y) {
+            for (uint x = 0; x < side; ++x) {
+                population += board->get(x, y);
+            }
+        }
+        differences += (chunked.population() != population);
+
+        if (differences != 0) {
+            std::cout << "  " << differences << " cells differ, " << text << std::endl;
+            passed = false;
+        }
+
+        delete board;
+        delete next;
+    }
+    return passed;
+}
+
+static bool checkFileBoard() {
+    bool passed = true;
+    ThreadPool pool(3);
+    const std::string path = "test_board.bin";
+
+    for (const char *text : {"B3/S23", "B2/S/C3"}) {
+        Rule rule;
+        parseRule(text, rule);
+        setLifeRule(rule);
+
+        for (Boundary boundary : {DEAD_EDGES, TORUS}) {
+            // Blocks of 16 rows, the last one short
+            const uint width = 200;
+            const uint height = 150;
+            uint planes = statePlanes(rule.states);
+            BitBoard *board = new BitBoard(width, height, planes);
+            BitBoard *next = new BitBoard(width, height, planes);
+            fillRandom(*board, 18, 35);
+
+            std::remove(path.c_str());
+            std::remove((path + ".next").c_str());
+            FileBoard *file = new FileBoard(path, width, height, planes);
+            FileBoard *fileNext = new FileBoard(path + ".next", width, height, planes);
+            for (uint y = 0; y < height; ++y) {
+                for (uint x = 0; x < width; ++x) {
+                    file->set(x, y, board->get(x, y));
+                }
+            }
+
+            for (uint g = 0; g < 30; ++g) {
+                if (!stepFileBoard(*file, *fileNext, 16, boundary, pool)) {
+                    std::cout << "  step failed" << std::endl;
+                    passed = false;
+                }
+                std::swap(file, fileNext);
+            }
+            stepReference(board, next, boundary, 30);
+
+            uint differences = countDifferences(*board, [file](uint x, uint y) {
+                uint state = 0;
+                for (uint p = 0; p < file->planes; ++p) {
+                    state |= file->get(x, y, p) << p;
+                }
+                return state;
+            });
+            if (differences != 0) {
+                std::cout << "  " << differences << " cells differ, " << text << " boundary " << boundary << std::endl;
+                passed = false;
+            }
+
+            delete board;
+            delete next;
+            delete file;
+            delete fileNext;
+        }
+    }
+
+    // An existing board is opened as it is, one of another size is refused
+    std::remove(path.c_str());
+    {
+        FileBoard board(path, 200, 150);
+        board.set(5, 7);
+    }
+    FileBoard resumed(path, 200, 150);
+    FileBoard wrongSize(path, 320, 150);
+    if (!resumed.isResumed() || !resumed.get(5, 7) || wrongSize.isOpen()) {
+        std::cout << "  existing board file not kept" << std::endl;
+        passed = false;
+    }
+
+    std::remove(path.c_str());
+    std::remove((path + ".next").c_str());
+    return passed;
+}
+
+static bool checkCluster() {
+    bool passed = true;
+    for (const char *text : {"B3/S23", "B2/S/C3"}) {
+        Rule rule;
+        parseRule(text, rule);
+        setLifeRule(rule);
+
+        for (Boundary boundary : {DEAD_EDGES, TORUS}) {
+            // A single rank on a torus links to itself
+            for (uint ranks : {1u, 3u}) {
+                const uint width = 200;
+                const uint height = 150;
+                uint planes = statePlanes(rule.states);
+                BitBoard *board = new BitBoard(width, height, planes);
+                BitBoard *next = new BitBoard(width, height, planes);
+                fillRandom(*board, 19, 35);
+
+                std::vector<std::string> addresses;
+                for (uint r = 0; r < ranks; ++r) {
+                    addresses.push_back("unix:test_rank" + std::to_string(r));
+                }
+
+                // Each rank steps its strip of rows on a thread of its own
+                std::vector<BitBoard *> strips(ranks);
+                std::vector<uint> firsts(ranks);
+                std::vector<uint> failures(ranks, 0);
+                std::vector<std::thread> threads;
+                for (uint r = 0; r < ranks; ++r) {
+                    firsts[r] = height * r / ranks;
+                    uint rows = height * (r + 1) / ranks - firsts[r];
+                    strips[r] = new BitBoard(width, rows + 2, planes);
+                    for (uint y = 0; y < rows; ++y) {
+                        for (uint x = 0; x < width; ++x) {
+                            strips[r]->setState(x, y + 1, board->state(x, firsts[r] + y));
+                        }
+                    }
+
+                    threads.emplace_back([&, r]() {
+                        Cluster cluster(r, addresses, boundary);
+                        ThreadPool pool(2);
+                        BitBoard *strip = strips[r];
+                        BitBoard *buffer = new BitBoard(width, strip->height, planes);
+                        double waited = 0;
+                        for (uint g = 0; g < 40 && cluster.isConnected(); ++g) {
+                            auto step = [&strip, &buffer](const Tile &tile) {
+                                stepTile(*strip, *buffer, tile.startWord, tile.endWord, tile.startY, tile.endY);
+                            };
+                            if (!stepStrip(cluster, *strip, *buffer, 1, boundary, pool, step, waited)) {
+                                ++failures[r];
+                                break;
+                            }
+                            std::swap(strip, buffer);
+                        }
+                        failures[r] += !cluster.isConnected();
+                        strips[r] = strip;
+                        delete buffer;
+                    });
+                }
+                for (std::thread &thread : threads) {
+                    thread.join();
+                }
+                stepReference(board, next, boundary, 40);
+
+                uint differences = countDifferences(*board, [&](uint x, uint y) {
+                    uint r = 0;
+                    while (r + 1 < ranks && y >= firsts[r + 1]) {
+                        ++r;
+                    }
+                    return strips[r]->state(x, y - firsts[r] + 1);
+                });
+                for (uint r = 0; r < ranks; ++r) {
+                    differences += failures[r];
+                    delete strips[r];
+                }
+                if (differences != 0) {
+                    std::cout << "  " << differences << " cells differ, " << text << " boundary " << boundary
+                              << " ranks " << ranks << std::endl;
+                    passed = false;
+                }
+
+                delete board;
+                delete next;
+            }
+        }
+    }
+
+    // A rank that goes away is noticed by its neighbour
+    std::vector<std::string> addresses = {"unix:test_rank0", "unix:test_rank1"};
+    Cluster *below = nullptr;
+    std::thread accepting([&addresses, &below]() {
+        below = new Cluster(1, addresses, DEAD_EDGES);
+    });
+    Cluster above(0, addresses, DEAD_EDGES);
+    accepting.join();
+    delete below;
+    char row[8] = {0};
+    if (above.exchange(row, row, row, row, sizeof(row))) {
+        std::cout << "  lost rank not noticed" << std::endl;
+        passed = false;
+    }
+
+    for (uint r = 0; r < 3; ++r) {
+        std::remove(("test_rank" + std::to_string(r)).c_str());
+    }
+    return passed;
+}
+
+static bool checkHashlife() {
+    // Big enough that the pattern never reaches the edges, which the
+    // plane of the quadtree does not have
+    const uint side = 320;
+    const uint first = 128;
+    const uint size = 64;
+    BitBoard *board = new BitBoard(side, side);
+    BitBoard *next = new BitBoard(side, side);
+    BitBoard pattern(size, size);
+    fillRandom(pattern, 24, 35);
+
+    QuadTree tree;
+    for (uint y = 0; y < size; ++y) {
+        for (uint x = 0; x < size; ++x) {
+            if (pattern.get(x, y)) {
+                board->set(first + x, first + y);
+                tree.addPixel(first + x, first + y);
+            }
+        }
+    }
+
+    // 2^5 generations in one step, then 45 more a power of two at a time
+    // with big blocks stepped across the pool
+    ThreadPool pool(3);
+    uint exponent = stepExponent();
+    setStepExponent(5);
+    tree.nextGeneration();
+    setStepExponent(exponent);
+    stepReference(board, next, DEAD_EDGES, 32);
+    uint differences = countDifferences(*board, [&tree](uint x, uint y) {
+        return tree.getPixel(x, y);
+    });
+
+    tree.advance(45, &pool);
+    stepReference(board, next, DEAD_EDGES, 45);
+    differences += countDifferences(*board, [&tree](uint x, uint y) {
+        return tree.getPixel(x, y);
+    });
+
+    // Frames of 3 generations step with exponents 0 and 1 in turn
+    for (uint frame = 0; frame < 4; ++frame) {
+        tree.advance(3, &pool);
+    }
+    stepReference(board, next, DEAD_EDGES, 12);
+    differences += countDifferences(*board, [&tree](uint x, uint y) {
+        return tree.getPixel(x, y);
+    });
+
+    bool passed = (differences == 0 && tree.generation == 89);
+    if (!passed) {
+        std::cout << "  " << differences << " cells differ at generation " << tree.generation << std::endl;
+    }
+
+    // A block in the middle of the root stays the root, so the block each
+    // step works on is the same and keeps a result for both exponents
+    QuadTree still;
+    still.addPixel(15, 15);
+    still.addPixel(16, 15);
+    still.addPixel(15, 16);
+    still.addPixel(16, 16);
+    GenData *root = still.root;
+    for (uint step : {0, 1, 0, 1}) {
+        setStepExponent(step);
+        still.nextGeneration();
+    }
+
+    GenData *e = still.nullData;
+    GenData *stepped = join(
+        join(e, e, e, root->nw), join(e, e, root->ne, e),
+        join(e, root->sw, e, e), join(root->se, e, e, e)
+    );
+    for (uint step : {0, 1}) {
+        setStepExponent(step);
+        if (still.root != root || getResult(stepped) != root) {
+            std::cout << "  result for 2^" << step << " not kept" << std::endl;
+            passed = false;
+        }
+    }
+    setStepExponent(exponent);
+
+    delete board;
+    delete next;
+    return passed;
+}
+
+int main() {
+    struct Check {
+        const char *name;
+        bool (*run)();
+    };
+    const Check checks[] = {
+        {"morton", checkMorton},
+        {"inplace", checkInPlace},
+        {"temporal", checkTemporal},
+        {"wavefront", checkWavefront},
+        {"ltl", checkLtl},
+        {"sparse", checkSparse},
+        {"chunked", checkChunked},
+        {"file", checkFileBoard},
+        {"cluster", checkCluster},
+        {"hashlife", checkHashlife},
+    };
+
+    int failed = 0;
+    for (const Check &check : checks) {
+        setLifeRule(CONWAY);
+        bool passed = check.run();
+        std::cout << (passed ? "PASS " : "FAIL ") << check.name << std::endl;
+        failed += !passed;
+    }
+    return failed;
+}
@@ -0,0 +1,214 @@
+/***********************************************
+ * Project: RaspberryConway
+ * File: threadpool.cpp
+ * By: ProgrammingIncluded
+ * Website: ProgrammingIncluded.github.io
+ * License: GNU GPLv3 (see LICENSE file)
+***********************************************/
+
+#include "threadpool.hpp"
+
+// Index of the queue of the running thread, 0 for the caller of run
+static thread_local uint CURRENT_WORKER = 0;
+
+ThreadPool::ThreadPool(uint threads) {
+    this->batch = 0;
+    this->busy = 0;
+    this->unfinished = 0;
+    this->queued = 0;
+    this->sleeping = 0;
+    this->stopping = false;
+
+    threads = (threads == 0) ? 1 : threads;
+    for (uint t = 0; t < threads; ++t) {
+        this->queues.push_back(std::unique_ptr<Queue>(new Queue()));
+    }
+    this->resetCounters();
+
+    // Calling thread does its share so only spawn the rest
+    for (uint t = 1; t < threads; ++t) {
+        this->workers.push_back(std::thread(&ThreadPool::workerLoop, this, t));
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> guard(this->lock);
+        this->stopping = true;
+    }
+    this->wake.notify_all();
+
+    for (std::thread &worker : this->workers) {
+        worker.join();
+    }
+}
+
+void ThreadPool::resetCounters() {
+    for (std::unique_ptr<Queue> &queue : this->queues) {
+        queue->executed = 0;
+        queue->stolen = 0;
+    }
+}
+
+void ThreadPool::run(uint tasks, const std::function<void(uint)> &task) {
+    ulint threads = this->size();
+    {
+        std::lock_guard<std::mutex> guard(this->lock);
+
+        // Deal out contiguous blocks, the remainder spread one each
+        for (ulint w = 0; w < threads; ++w) {
+            Queue &queue = *this->queues[w];
+            std::lock_guard<std::mutex> queueGuard(queue.lock);
+            for (uint i = tasks * w / threads; i < tasks * (w + 1) / threads; ++i) {
+                queue.tasks.push_back({&task, i, nullptr});
+            }
+        }
+
+        this->busy = this->workers.size();
+        this->unfinished = tasks;
+        this->queued += tasks;
+        this->batch += 1;
+    }
+    this->wake.notify_all();
+
+    this->drain(0);
+
+    // Wait for every worker to check in so task can go out of scope
+    std::unique_lock<std::mutex> guard(this->lock);
+    this->done.wait(guard, [this] { return this->busy == 0; });
+}
+
+bool ThreadPool::pop(uint self, Task &task) {
+    Queue &queue = *this->queues[self];
+    std::lock_guard<std::mutex> guard(queue.lock);
+    if (queue.tasks.empty()) {
+        return false;
+    }
+
+    task = queue.tasks.front();
+    queue.tasks.pop_front();
+    this->queued -= 1;
+    return true;
+}
+
+bool ThreadPool::steal(uint self, Task &task) {
+    // Try everyone else once, starting with the next worker along
+    uint threads = this->queues.size();
+    for (uint i = 1; i < threads; ++i) {
+        Queue &victim = *this->queues[(self + i) % threads];
+        std::lock_guard<std::mutex> guard(victim.lock);
+        if (!victim.tasks.empty()) {
+            task = victim.tasks.back();
+            victim.tasks.pop_back();
+            this->queued -= 1;
+            return true;
+        }
+    }
+    return false;
+}
+
+void ThreadPool::fork(uint tasks, const std::function<void(uint)> &task) {
+    uint self = CURRENT_WORKER;
+    std::atomic<uint> left(tasks);
+    this->unfinished += tasks;
+    {
+        // Pushed in reverse, so this thread takes them in order
+        Queue &queue = *this->queues[self];
+        std::lock_guard<std::mutex> guard(queue.lock);
+        for (uint i = tasks; i > 0; --i) {
+            queue.tasks.push_front({&task, i - 1, &left});
+        }
+    }
+    this->queued += tasks;
+    this->wakeIdle();
+
+    // Help with whatever is queued until the last task of the fork is
+    // done, sleeping while there is nothing to take
+    while (left != 0) {
+        if (this->execute(self)) {
+            continue;
+        }
+
+        std::unique_lock<std::mutex> guard(this->lock);
+        this->sleeping += 1;
+        this->idle.wait(guard, [this, &left] { return this->queued != 0 || left == 0; });
+        this->sleeping -= 1;
+    }
+}
+
+void ThreadPool::wakeIdle() {
+    // A thread about to sleep counts itself before it checks for work
+    // under the lock, so either it sees the change or it is counted here
+    if (this->sleeping != 0) {
+        {
+            std::lock_guard<std::mutex> guard(this->lock);
+        }
+        this->idle.notify_all();
+    }
+}
+
+bool ThreadPool::execute(uint self) {
+    Queue &queue = *this->queues[self];
+    Task task;
+    bool stolen = false;
+    if (!this->pop(self, task)) {
+        if (!this->steal(self, task)) {
+            return false;
+        }
+        stolen = true;
+    }
+
+    (*task.call)(task.index);
+    queue.executed += 1;
+    queue.stolen += stolen;
+
+    // The last task of a fork or of the batch lets its waiters go. left
+    // belongs to the forking thread and is gone once it sees 0.
+    bool last = (task.left != nullptr && --*task.left == 0);
+    last |= (--this->unfinished == 0);
+    if (last) {
+        this->wakeIdle();
+    }
+    return true;
+}
+
+void ThreadPool::drain(uint self) {
+    // Running tasks can still fork more, so every deque being empty only
+    // ends the batch once nothing is running either
+    for (;;) {
+        if (this->execute(self)) {
+            continue;
+        }
+
+        std::unique_lock<std::mutex> guard(this->lock);
+        this->sleeping += 1;
+        this->idle.wait(guard, [this] { return this->queued != 0 || this->unfinished == 0; });
+        this->sleeping -= 1;
+        if (this->unfinished == 0) {
+            return;
+        }
+    }
+}
+
+void ThreadPool::workerLoop(uint self) {
+    CURRENT_WORKER = self;
+    ulint seen = 0;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> guard(this->lock);
+            this->wake.wait(guard, [this, seen] { return this->stopping || this->batch != seen; });
+            if (this->stopping) {
+                return;
+            }
+            seen = this->batch;
+        }
+
+        this->drain(self);
+
+        std::lock_guard<std::mutex> guard(this->lock);
+        this->busy -= 1;
+        if (this->busy == 0) {
+            this->done.notify_one();
+        }
+    }
+}
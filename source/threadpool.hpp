@@ -0,0 +1,116 @@
+/***********************************************
+ * Project: RaspberryConway
+ * File: threadpool.hpp
+ * By: ProgrammingIncluded
+ * Website: ProgrammingIncluded.github.io
+ * License: GNU GPLv3 (see LICENSE file)
+***********************************************/
+#ifndef THREADPOOL_HPP
+#define THREADPOOL_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+typedef unsigned int uint;
+typedef unsigned long long int ulint;
+
+// Long lived workers for the generation loop. Threads are created once
+// and park on a condition variable between calls to run.
+//
+// Every worker has its own deque of tasks. A batch is dealt out in
+// contiguous blocks, workers take from the front of their own deque and
+// once it is empty steal from the back of the others, so uneven tasks or
+// a busy core do not hold up the rest. Tasks can fork tasks of their own,
+// which go on the front of the deque of the thread forking them.
+class ThreadPool {
+    public:
+        // Total threads including the calling thread
+        ThreadPool(uint threads);
+        ~ThreadPool();
+
+        uint size() const {
+            return this->workers.size() + 1;
+        }
+
+        // Call task(i) for every i in [0, tasks) across the pool and the
+        // calling thread. Returns once all of them have finished.
+        void run(uint tasks, const std::function<void(uint)> &task);
+
+        // Call task(i) for every i in [0, tasks) from within a task given
+        // to run, and return once all of them have finished. Idle threads
+        // take them from the back while the calling thread works through
+        // them from the front, and runs any other task while it waits. It
+        // sleeps once there is nothing left to run.
+        void fork(uint tasks, const std::function<void(uint)> &task);
+
+        // Tasks run and tasks stolen from another worker by worker w since
+        // the last reset. Worker 0 is the thread calling run.
+        ulint executed(uint w) const {
+            return this->queues[w]->executed;
+        }
+
+        ulint stolen(uint w) const {
+            return this->queues[w]->stolen;
+        }
+
+        void resetCounters();
+
+    private:
+        struct Task {
+            const std::function<void(uint)> *call;
+            uint index;
+            // Tasks of the fork still to finish, nullptr for run
+            std::atomic<uint> *left;
+        };
+
+        struct Queue {
+            std::mutex lock;
+            std::deque<Task> tasks;
+            ulint executed;
+            ulint stolen;
+        };
+
+        std::vector<std::thread> workers;
+        // One per thread, index 0 belongs to the caller of run
+        std::vector<std::unique_ptr<Queue>> queues;
+        std::mutex lock;
+        // Workers wait here for the next batch
+        std::condition_variable wake;
+        // run waits here for the last worker of a batch
+        std::condition_variable done;
+        // Threads with nothing to run wait here for a task to be queued,
+        // or for the batch or their fork to finish
+        std::condition_variable idle;
+
+        // Bumped for every batch so parked workers know to start
+        ulint batch;
+        // Workers still busy with the current batch
+        uint busy;
+        // Tasks of the current batch, forked ones included, still queued
+        // or running
+        std::atomic<ulint> unfinished;
+        // Tasks sitting in a deque
+        std::atomic<ulint> queued;
+        // Threads waiting on idle, so the rest only take the lock to wake
+        // them when there is someone to wake
+        std::atomic<uint> sleeping;
+        bool stopping;
+
+        void workerLoop(uint self);
+        void drain(uint self);
+        bool execute(uint self);
+        bool pop(uint self, Task &task);
+        bool steal(uint self, Task &task);
+        void wakeIdle();
+
+        // Disallow copy constructor
+        ThreadPool(const ThreadPool&) = delete;
+};
+
+#endif /* THREADPOOL_HPP */
@@ -0,0 +1,78 @@
+/***********************************************
+ * Project: RaspberryConway
+ * File: tiling.cpp
+ * By: ProgrammingIncluded
+ * Website: ProgrammingIncluded.github.io
+ * License: GNU GPLv3 (see LICENSE file)
+***********************************************/
+
+#include "tiling.hpp"
+
+#include <algorithm>
+
+TileGrid::TileGrid(const BitBoard &board, uint tileWidth, uint tileHeight) {
+    uint tileWords = std::max(1u, (tileWidth + 63) / 64);
+    tileHeight = std::max(1u, tileHeight);
+
+    this->columns = (board.stride + tileWords - 1) / tileWords;
+    this->rows = (board.height + tileHeight - 1) / tileHeight;
+    this->minWidth = board.width;
+    this->minHeight = board.height;
+
+    for (uint row = 0; row < this->rows; ++row) {
+        for (uint column = 0; column < this->columns; ++column) {
+            Tile tile;
+            tile.startWord = column * tileWords;
+            tile.endWord = std::min(board.stride, tile.startWord + tileWords);
+            tile.startY = row * tileHeight;
+            tile.endY = std::min(board.height, tile.startY + tileHeight);
+            this->tiles.push_back(tile);
+
+            uint cells = std::min(board.width, tile.endWord * 64) - tile.startWord * 64;
+            this->minWidth = std::min(this->minWidth, cells);
+            this->minHeight = std::min(this->minHeight, tile.endY - tile.startY);
+        }
+    }
+
+    this->markAllChanged();
+}
+
+uint TileGrid::reach(uint steps) const {
+    uint extent = std::min(this->minWidth, this->minHeight);
+    return std::max(1u, (steps + extent - 1) / extent);
+}
+
+void TileGrid::markActive(Boundary boundary, uint steps) {
+    int reach = this->reach(steps);
+    this->active.clear();
+
+    for (uint row = 0; row < this->rows; ++row) {
+        for (uint column = 0; column < this->columns; ++column) {
+            bool active = false;
+            for (int dy = -reach; dy <= reach && !active; ++dy) {
+                for (int dx = -reach; dx <= reach && !active; ++dx) {
+                    int x = column + dx;
+                    int y = row + dy;
+                    if (boundary == TORUS) {
+                        x = (x + this->columns) % this->columns;
+                        y = (y + this->rows) % this->rows;
+                    } else if (x < 0 || y < 0 || x >= (int) this->columns || y >= (int) this->rows) {
+                        continue;
+                    }
+                    active = this->changed[this->index(x, y)];
+                }
+            }
+
+            if (active) {
+                this->active.push_back(this->index(column, row));
+            }
+        }
+    }
+
+    // Skipped tiles stay unchanged, stepped tiles report their own
+    this->changed.assign(this->tiles.size(), false);
+}
+
+void TileGrid::markAllChanged() {
+    this->changed.assign(this->tiles.size(), true);
+}
@@ -0,0 +1,70 @@
+/***********************************************
+ * Project: RaspberryConway
+ * File: tiling.hpp
+ * By: ProgrammingIncluded
+ * Website: ProgrammingIncluded.github.io
+ * License: GNU GPLv3 (see LICENSE file)
+***********************************************/
+#ifndef TILING_HPP
+#define TILING_HPP
+
+#include "bitboard.hpp"
+
+#include <vector>
+
+// Rectangle of a BitBoard in whole words
+struct Tile {
+    uint startWord; // Inclusive
+    uint endWord; // Exclusive
+    uint startY; // Inclusive
+    uint endY; // Exclusive
+};
+
+// Splits a board into 2D tiles small enough to stay in cache while they
+// are stepped. Tiles on the right and bottom edges take the remainder so
+// every cell is covered whatever the board size.
+//
+// Also tracks which tiles are active. A tile whose 3x3 neighbourhood of
+// tiles did not change last generation cannot change this generation, and
+// since it did not change both boards already hold the same cells for it,
+// so it can be skipped entirely. When several generations are stepped at
+// once the neighbourhood grows to cover every cell the tile depends on.
+class TileGrid {
+    public:
+        // Tiles in row major order
+        std::vector<Tile> tiles;
+        uint columns;
+        uint rows;
+        // Smallest tile in cells, edge tiles can be thinner than the rest
+        uint minWidth;
+        uint minHeight;
+
+        // Tiles that changed during the last generation, set by the step.
+        // Starts all set so the first generation steps everything.
+        std::vector<char> changed;
+        // Tiles to step this generation, filled by markActive
+        std::vector<uint> active;
+
+        // Tile width is in cells and rounded up to whole words
+        TileGrid(const BitBoard &board, uint tileWidth, uint tileHeight);
+
+        inline uint size() const {
+            return this->tiles.size();
+        }
+
+        inline uint index(uint column, uint row) const {
+            return column + (row * this->columns);
+        }
+
+        // Tiles either side a tile depends on when stepped steps generations
+        uint reach(uint steps) const;
+
+        // Fill active from changed, wrapping around the edges on a torus.
+        // Clears changed ready for the stepped tiles to report into.
+        void markActive(Boundary boundary, uint steps = 1);
+
+        // Step every tile again, needed after cells are edited directly
+        void markAllChanged();
+};
+
+#endif /* TILING_HPP */
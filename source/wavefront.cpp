@@ -0,0 +1,124 @@
+/***********************************************
+ * Project: RaspberryConway
+ * File: wavefront.cpp
+ * By: ProgrammingIncluded
+ * Website: ProgrammingIncluded.github.io
+ * License: GNU GPLv3 (see LICENSE file)
+***********************************************/
+
+#include "wavefront.hpp"
+
+#include <algorithm>
+
+Wavefront::Wavefront(const TileGrid &grid, Boundary boundary, uint reach) {
+    this->stepped = 0;
+    this->passCount = 0;
+    this->remaining = 0;
+    this->neighbours.resize(grid.size());
+    this->done.assign(grid.size(), 0);
+    this->queued.assign(grid.size(), false);
+    // Everything counts as changed before the first pass
+    this->changed.assign(grid.size() * 2, true);
+
+    int r = reach;
+    for (uint row = 0; row < grid.rows; ++row) {
+        for (uint column = 0; column < grid.columns; ++column) {
+            std::vector<uint> &list = this->neighbours[grid.index(column, row)];
+            for (int dy = -r; dy <= r; ++dy) {
+                for (int dx = -r; dx <= r; ++dx) {
+                    int x = column + dx;
+                    int y = row + dy;
+                    if (boundary == TORUS) {
+                        x = ((x % (int) grid.columns) + grid.columns) % grid.columns;
+                        y = ((y % (int) grid.rows) + grid.rows) % grid.rows;
+                    } else if (x < 0 || y < 0 || x >= (int) grid.columns || y >= (int) grid.rows) {
+                        continue;
+                    }
+                    list.push_back(grid.index(x, y));
+                }
+            }
+
+            // Small boards on a torus wrap onto the same tiles
+            std::sort(list.begin(), list.end());
+            list.erase(std::unique(list.begin(), list.end()), list.end());
+        }
+    }
+}
+
+bool Wavefront::isReady(uint tile, uint passes) const {
+    uint pass = this->done[tile];
+    if (this->queued[tile] || pass >= passes) {
+        return false;
+    }
+
+    for (uint n : this->neighbours[tile]) {
+        if (this->done[n] < pass) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void Wavefront::run(ThreadPool &pool, uint passes, const std::function<bool(uint, uint)> &step) {
+    uint tiles = this->done.size();
+    this->stepped = 0;
+    this->remaining = (ulint) tiles * passes;
+    std::fill(this->done.begin(), this->done.end(), 0);
+
+    // Every tile can start its first pass
+    this->ready.clear();
+    for (uint t = 0; t < tiles && passes > 0; ++t) {
+        this->queued[t] = true;
+        this->ready.push_back(t);
+    }
+
+    // Each thread of the pool pulls ready tiles until all passes are done
+    pool.run(pool.size(), [this, passes, &step](uint) {
+        this->work(passes, step);
+    });
+
+    this->passCount += passes;
+}
+
+void Wavefront::work(uint passes, const std::function<bool(uint, uint)> &step) {
+    std::unique_lock<std::mutex> guard(this->lock);
+    for (;;) {
+        this->wake.wait(guard, [this] { return !this->ready.empty() || this->remaining == 0; });
+        if (this->remaining == 0) {
+            return;
+        }
+
+        uint tile = this->ready.front();
+        this->ready.pop_front();
+        uint pass = this->done[tile];
+        guard.unlock();
+
+        // Neighbours have all finished the previous pass so their flags
+        // for it are settled and visible through the lock
+        uint before = (this->passCount + pass) % 2;
+        bool active = false;
+        for (uint n : this->neighbours[tile]) {
+            active = active || this->changed[n * 2 + before];
+        }
+        this->changed[tile * 2 + (before ^ 1)] = active && step(tile, pass);
+
+        guard.lock();
+        this->stepped += active;
+        this->done[tile] += 1;
+        this->queued[tile] = false;
+        this->remaining -= 1;
+
+        // Finishing a pass can only unblock this tile or its neighbours
+        for (uint n : this->neighbours[tile]) {
+            if (this->isReady(n, passes)) {
+                this->queued[n] = true;
+                this->ready.push_back(n);
+                this->wake.notify_one();
+            }
+        }
+
+        if (this->remaining == 0) {
+            this->wake.notify_all();
+        }
+    }
+}
@@ -0,0 +1,63 @@
+/***********************************************
+ * Project: RaspberryConway
+ * File: wavefront.hpp
+ * By: ProgrammingIncluded
+ * Website: ProgrammingIncluded.github.io
+ * License: GNU GPLv3 (see LICENSE file)
+***********************************************/
+#ifndef WAVEFRONT_HPP
+#define WAVEFRONT_HPP
+
+#include "threadpool.hpp"
+#include "tiling.hpp"
+
+#include <deque>
+
+// Runs several passes over a TileGrid without a barrier between them.
+// A tile moves on to its next pass as soon as every tile it depends on
+// has finished the pass before, so fast and slow regions overlap across
+// generations. Neighbouring tiles are never more than one pass apart,
+// which keeps two boards enough: a tile only overwrites a pass once all
+// of its neighbours are done reading it.
+//
+// Tiles whose neighbourhood did not change the pass before are skipped,
+// the same as TileGrid::markActive.
+class Wavefront {
+    public:
+        // Tiles actually stepped during the last run
+        ulint stepped;
+
+        // Tiles depend on the tiles within reach of them, see TileGrid::reach
+        Wavefront(const TileGrid &grid, Boundary boundary, uint reach);
+
+        // Advance every tile passes times using the pool. step(tile, pass)
+        // steps a tile from the board of that pass into the other board
+        // and returns true if the tile changed. Boards alternate by pass.
+        void run(ThreadPool &pool, uint passes, const std::function<bool(uint, uint)> &step);
+
+    private:
+        // Tiles each tile depends on, including itself
+        std::vector<std::vector<uint>> neighbours;
+        // Passes each tile has finished in the current run
+        std::vector<uint> done;
+        // Tiles waiting in ready
+        std::vector<char> queued;
+        // Whether a tile changed, two slots alternating by pass
+        std::vector<char> changed;
+        // Passes finished over all runs, picks the changed slot
+        ulint passCount;
+
+        std::deque<uint> ready;
+        std::mutex lock;
+        std::condition_variable wake;
+        // Tile passes left in the current run
+        ulint remaining;
+
+        bool isReady(uint tile, uint passes) const;
+        void work(uint passes, const std::function<bool(uint, uint)> &step);
+
+        // Disallow copy constructor
+        Wavefront(const Wavefront&) = delete;
+};
+
+#endif /* WAVEFRONT_HPP */